@@ -1,7 +1,12 @@
+#include <algorithm>
+#include <chrono>
+#include <thread>
 
 #include "xxh3.h"
+#include "glm/gtc/matrix_transform.hpp"
 
 #include "DebugDrawManager.hpp"
+#include "LockStats.hpp"
 #include "SM/DebugDrawer.hpp"
 
 using namespace SM;
@@ -10,6 +15,59 @@ constexpr Vec3 UP = {0.0f, 0.0f, 1.0f};
 constexpr float ArrowHeadLength = 0.5f;
 constexpr float TransformArrowHeadLength = 0.25f;
 constexpr float ArrowheadAngle = glm::radians(25.0f);
+constexpr float CameraNearPlane = 0.05f;
+constexpr float CameraFarPlane = 100000.0f;
+constexpr uint64 TimerTicksPerSecond = 100;
+constexpr uint32 MaxWorkerThreads = 32;
+// Staged line vertices a thread may queue before render() takes them, more are dropped
+constexpr uint64 MaxStagedLineVertices = 4 * 1024 * 1024;
+// Shapes handed to a worker at once
+constexpr uint32 WorkerGrainSize = 512;
+static const float ArrowheadCos = cos(ArrowheadAngle);
+static const float ArrowheadSin = sin(ArrowheadAngle);
+
+static uint64 GetTimeTick() {
+	auto now = std::chrono::steady_clock::now().time_since_epoch();
+	return uint64(std::chrono::duration_cast<std::chrono::milliseconds>(now).count()) / (1000 / TimerTicksPerSecond);
+}
+
+static uint64 HashName(const std::string_view& name) {
+#ifdef DEBUGDRAW_NAME_HASH_BITS
+	// Keeps only the lowest bits, so tests can make names collide
+	return XXH3_64bits(name.data(), name.size()) & ((uint64(1) << DEBUGDRAW_NAME_HASH_BITS) - 1);
+#else
+	return XXH3_64bits(name.data(), name.size());
+#endif
+}
+
+static bool HasName(const DebugGroup& group, uint32 id, const std::string_view& name) {
+	// Handle shapes don't have names, their keys can't collide
+	return id == NamePool::InvalidId || group.names.get(id) == name;
+}
+
+// Returns the key a name is stored under, which is its hash unless that collided with another name
+static uint64 GetNameKey(const DebugGroup& group, const std::string_view& name, uint64 hash) {
+	uint32 id = group.names.find(name);
+	if ( id != NamePool::InvalidId )
+		return group.names[id].key;
+
+	// Not in use yet, so any shape under the key belongs to a different name
+	uint64 key = hash;
+	while ( group.arrows.contains(key) || group.spheres.contains(key) || group.transforms.contains(key) )
+		++key;
+	return key;
+}
+
+// Looks the shape up by the name's hash first and verifies the name.
+// Only falls back to the name index if there is no shape under the hash or it belongs to a different name.
+template <typename Shape>
+static Shape* FindShape(DebugGroup& group, DenseMap<uint64, Shape>& shapes, const std::string_view& name, uint64& key) {
+	Shape* pShape = shapes.find(key);
+	if ( pShape != nullptr && HasName(group, pShape->name, name) )
+		return pShape;
+	key = GetNameKey(group, name, key);
+	return shapes.find(key);
+}
 
 static uint8 GetSphereSizeLevel(float radius) {
 	if ( radius <= 0.25f )
@@ -20,30 +78,113 @@ static uint8 GetSphereSizeLevel(float radius) {
 		return 2;
 }
 
-static void GenerateArrowHeadLines(const Vec3& arrowDir, Vec3* pArrHeadLines) {
-	Vec3 dirNorm = glm::normalize(arrowDir);
+// Picks the level by the sphere's radius relative to the visible height at its distance
+static uint8 GetSphereProjectedLevel(float radius, float distance, float tanHalfFov) {
+	if ( distance <= radius )
+		return 2;
+	float screenSize = radius / (distance * tanHalfFov);
+	if ( screenSize < 0.05f )
+		return 0;
+	else if ( screenSize < 0.25f )
+		return 1;
+	else
+		return 2;
+}
+
+static BoundingSphere GetArrowBounds(const Vec3& begin, const Vec3& end, float headLineLength) {
+	return {(begin + end) * 0.5f, glm::distance(begin, end) * 0.5f + headLineLength};
+}
+
+static BoundingSphere GetTransformBounds(const Vec3& origin, const Vec3& scale) {
+	Vec3 absScale = glm::abs(scale);
+	return {origin, max(absScale.x, max(absScale.y, absScale.z)) + TransformArrowHeadLength};
+}
+
+// Expects a normalized direction.
+// The head lines are built from an orthonormal basis, so they are already normalized as well.
+static void GenerateArrowHeadLines(const Vec3& dirNorm, Vec3* pArrHeadLines) {
 	Vec3 up = UP;
 	if ( glm::abs(glm::dot(dirNorm, up)) > 0.99f )
 		up = Vec3(0.0f, 1.0f, 0.0f);
-	Vec3 right = glm::normalize(glm::cross(dirNorm, up));
-	Vec3 oUp = glm::normalize(glm::cross(right, dirNorm));
+	Vec3 right = glm::normalize(glm::cross(dirNorm, up)) * ArrowheadSin;
+	Vec3 oUp = glm::cross(right, dirNorm);
+	Vec3 back = -dirNorm * ArrowheadCos;
+
+	pArrHeadLines[0] = back + right;
+	pArrHeadLines[1] = back - right;
+	pArrHeadLines[2] = back + oUp;
+	pArrHeadLines[3] = back - oUp;
+}
 
-	pArrHeadLines[0] = glm::normalize(-dirNorm * cos(ArrowheadAngle) + right * sin(ArrowheadAngle));
-	pArrHeadLines[1] = glm::normalize(-dirNorm * cos(ArrowheadAngle) - right * sin(ArrowheadAngle));
-	pArrHeadLines[2] = glm::normalize(-dirNorm * cos(ArrowheadAngle) + oUp * sin(ArrowheadAngle));
-	pArrHeadLines[3] = glm::normalize(-dirNorm * cos(ArrowheadAngle) - oUp * sin(ArrowheadAngle));
+static LineVertex* GenerateLine(LineVertex* pVertices, const Vec3& begin, const Vec3& end, u8Vec4 color) {
+	pVertices[0] = {begin, color};
+	pVertices[1] = {end, color};
+	return pVertices + 2;
 }
 
-static void DrawArrow(DebugDrawer* pDrawer, const Vec3& begin, const Vec3& end, u8Vec3 color, float headLineLength) {
+// Always generates ArrowVertexCount vertices
+static LineVertex* GenerateArrow(LineVertex* pVertices, const Vec3& begin, const Vec3& end, u8Vec4 color, float headLineLength) {
+	pVertices = GenerateLine(pVertices, begin, end, color);
+
 	Vec3 arrowDir = end - begin;
 	float length = glm::length(arrowDir);
+	if ( length <= 0.0f ) {
+		for ( uint32 i = 0; i < 4; ++i )
+			pVertices = GenerateLine(pVertices, end, end, color);
+		return pVertices;
+	}
 
 	Vec3 headLines[4];
-	GenerateArrowHeadLines(arrowDir, headLines);
+	GenerateArrowHeadLines(arrowDir / length, headLines);
 
-	pDrawer->drawLine(begin, end, color);
+	float headLength = min(headLineLength, length);
 	for ( const Vec3& dir : headLines )
-		pDrawer->drawLine(end, end + dir * min(headLineLength, length), color);
+		pVertices = GenerateLine(pVertices, end, end + dir * headLength, color);
+	return pVertices;
+}
+
+static void GenerateArrow(DebugArrow& arrow) {
+	GenerateArrow(arrow.vertices.data(), arrow.begin, arrow.end, ToLineVertexColor(arrow.color), ArrowHeadLength);
+}
+
+static void GenerateSphere(LineVertex* pVertices, const Vec3& position, float radius, u8Vec4 color, const IcoSphere& unitSphere) {
+	for ( const IcoSphere::Line& line : unitSphere.getLines() )
+		pVertices = GenerateLine(pVertices, position + line.begin * radius, position + line.end * radius, color);
+}
+
+static void GenerateSphere(DebugSphere& sphere, const IcoSphere& unitSphere) {
+	sphere.vertices.resize(unitSphere.getLines().size() * 2);
+	GenerateSphere(sphere.vertices.data(), sphere.position, sphere.radius, ToLineVertexColor(sphere.color), unitSphere);
+}
+
+// Generates one axis of a transform gizmo.
+// The other two axes of the rotation are perpendicular to it already, so they span the head without building a basis.
+static LineVertex* GenerateTransformAxis(
+	LineVertex* pVertices, const Vec3& origin, const Vec3& axis, float scale, const Vec3& side, const Vec3& up, u8Vec4 color
+) {
+	Vec3 end = origin + axis * scale;
+	pVertices = GenerateLine(pVertices, origin, end, color);
+
+	float length = glm::abs(scale);
+	float headLength = min(TransformArrowHeadLength, length);
+	Vec3 back = axis * (scale < 0.0f ? ArrowheadCos * headLength : -ArrowheadCos * headLength);
+	Vec3 right = side * (ArrowheadSin * headLength);
+	Vec3 oUp = up * (ArrowheadSin * headLength);
+	pVertices = GenerateLine(pVertices, end, end + back + right, color);
+	pVertices = GenerateLine(pVertices, end, end + back - right, color);
+	pVertices = GenerateLine(pVertices, end, end + back + oUp, color);
+	pVertices = GenerateLine(pVertices, end, end + back - oUp, color);
+	return pVertices;
+}
+
+static void GenerateTransform(DebugTransform& transform) {
+	// Columns are the rotated unit axes
+	Mat3 basis = glm::mat3_cast(transform.rotation);
+
+	LineVertex* pVertices = transform.vertices.data();
+	pVertices = GenerateTransformAxis(pVertices, transform.origin, basis[0], transform.scale.x, basis[1], basis[2], ToLineVertexColor({0xFF, 0x00, 0x00}));
+	pVertices = GenerateTransformAxis(pVertices, transform.origin, basis[1], transform.scale.y, basis[2], basis[0], ToLineVertexColor({0x00, 0xFF, 0x00}));
+	pVertices = GenerateTransformAxis(pVertices, transform.origin, basis[2], transform.scale.z, basis[0], basis[1], ToLineVertexColor({0x00, 0x00, 0xFF}));
 }
 
 
@@ -54,6 +195,8 @@ DebugDrawManager::DebugDrawManager() {
 	for ( uint8 i = 0; i < std::size(m_arrBaseSphereLevels); ++i )
 		m_arrBaseSphereLevels[i] = IcoSphere(i);
 
+	m_timeOrigin = GetTimeTick();
+
 	LPSTR cmdLine = GetCommandLineA();
 	if ( std::string_view(cmdLine).find("-debugDraw") != std::string::npos )
 		m_bEnabled = true;
@@ -68,134 +211,977 @@ void DebugDrawManager::render() {
 	if ( !m_bEnabled )
 		return;
 
-	DebugDrawer* pDrawer = DebugDrawer::Get();
+	expireShapes();
 
-	std::scoped_lock lock0(m_mutex);
-	std::scoped_lock lock1(pDrawer->getLock());
+	m_producers.advance();
+	applyCommands();
+	takeStagedLines();
 
-	// Draw arrows
-	for ( const auto& [k, arrow] : m_mapArrows )
-		DrawArrow(pDrawer, arrow.begin, arrow.end, arrow.color, ArrowHeadLength);
+	updateCamera();
 
-	// Draw spheres
-	for ( const auto& [k, sphere] : m_mapSpheres ) {
-		for ( const IcoSphere::Line& line : sphere.shape.getLines() )
-			pDrawer->drawLine(sphere.position + line.begin, sphere.position + line.end, sphere.color);
+	FrameStats stats = {};
+	// Size the visible lists for every shape of the visible groups
+	uint32 arrowCount = m_handleShapes.arrows.size();
+	uint32 sphereCount = m_handleShapes.spheres.size();
+	uint32 transformCount = m_handleShapes.transforms.size();
+	for ( auto it = m_mapGroups.begin(); it != m_mapGroups.end(); ) {
+		DebugGroup& group = *it->second;
+		// Groups are created again once something is added to them, only hidden ones have to keep existing while empty
+		if ( group.visible && group.arrows.empty() && group.spheres.empty() && group.transforms.empty() ) {
+			it = m_mapGroups.erase(it);
+			continue;
+		}
+		if ( group.visible ) {
+			arrowCount += group.arrows.size();
+			sphereCount += group.spheres.size();
+			transformCount += group.transforms.size();
+		}
+		++it;
+	}
+	m_visibleArrows = FrameArray<DebugArrow*>(m_frameArena, arrowCount);
+	m_visibleSpheres = FrameArray<DebugSphere*>(m_frameArena, sphereCount);
+	m_visibleTransforms = FrameArray<DebugTransform*>(m_frameArena, transformCount);
+	for ( auto& [id, pGroup] : m_mapGroups ) {
+		if ( pGroup->visible )
+			collectVisible(*pGroup, stats);
 	}
+	collectVisible(m_handleShapes, stats);
 
-	// Draw transforms
-	for ( const auto& [k, transform] : m_mapTransforms ) {
-		Vec3 x = transform.rotation * Vec3(transform.scale.x, 0.0f, 0.0f);
-		Vec3 y = transform.rotation * Vec3(0.0f, transform.scale.y, 0.0f);
-		Vec3 z = transform.rotation * Vec3(0.0f, 0.0f, transform.scale.z);
+	std::scoped_lock workerPoolLock(m_workerPoolMutex);
+	uint32 workerThreads = min(max(m_workerThreads.load(), 1u), MaxWorkerThreads);
+	if ( !m_pWorkerPool || m_pWorkerPool->getThreadCount() != workerThreads )
+		m_pWorkerPool = std::make_unique<WorkerPool>(workerThreads);
+
+	// Regenerate changed geometry and count the vertices before taking the drawer lock.
+	// Shapes are indexed arrows first, then spheres, then transforms.
+	uint32 shapeCount = uint32(m_visibleArrows.size() + m_visibleSpheres.size() + m_visibleTransforms.size());
+	auto regenerate = [this](uint32 begin, uint32 end) {regenerateShapes(begin, end);};
+	m_pWorkerPool->parallelFor(shapeCount, WorkerGrainSize, regenerate);
+
+	// Where each sphere's vertices start, relative to the first sphere
+	uint32* pArrSphereOffsets = m_frameArena.allocate<uint32>(m_visibleSpheres.size());
+	uint32 sphereVertexCount = 0;
+	for ( uint32 i = 0; i < m_visibleSpheres.size(); ++i ) {
+		pArrSphereOffsets[i] = sphereVertexCount;
+		sphereVertexCount += uint32(m_visibleSpheres[i]->vertices.size());
+	}
+	uint32 shapeVertexCount = uint32(m_visibleArrows.size()) * ArrowVertexCount + sphereVertexCount
+		+ uint32(m_visibleTransforms.size()) * TransformVertexCount;
+	uint32 vertexCount = shapeVertexCount + m_mapLines.size() * 2;
+
+	uint32 budget = m_vertexBudget;
+	uint32 lineVertexCount = uint32(m_vecLineVertices.size());
+	if ( vertexCount != 0 || lineVertexCount != 0 ) {
+		DebugDrawer* pDrawer = DebugDrawer::Get();
+		DEBUGDRAW_LOCK_GUARD(lock, pDrawer->getLock(), "render drawer");
+		if ( budget != 0 && vertexCount > budget ) {
+			pDrawer->reserveVertices(budget + lineVertexCount);
+			emitWithBudget(pDrawer, budget, stats);
+		} else {
+			pDrawer->reserveVertices(vertexCount + lineVertexCount);
+
+			// Every shape's place is known, so the workers copy straight into the drawer's array
+			if ( shapeVertexCount != 0 ) {
+				LineVertex* pVertices = pDrawer->appendVertices(shapeVertexCount);
+				auto copy = [&](uint32 begin, uint32 end) {copyShapes(pVertices, pArrSphereOffsets, begin, end);};
+				m_pWorkerPool->parallelFor(shapeCount, WorkerGrainSize, copy);
+			}
+
+			for ( const DebugLine& line : m_mapLines )
+				pDrawer->drawVertices(line.vertices.data(), 2);
+
+			stats.emittedVertices = vertexCount;
+		}
 
-		DrawArrow(pDrawer, transform.origin, transform.origin + x, {0xFF, 0x00, 0x00}, TransformArrowHeadLength);
-		DrawArrow(pDrawer, transform.origin, transform.origin + y, {0x00, 0xFF, 0x00}, TransformArrowHeadLength);
-		DrawArrow(pDrawer, transform.origin, transform.origin + z, {0x00, 0x00, 0xFF}, TransformArrowHeadLength);
+		// Staged lines are not limited by the budget, same as when they were drawn directly
+		pDrawer->drawVertices(m_vecLineVertices.data(), lineVertexCount);
 	}
+	retireDrawnLines();
+
+	stats.arenaUsedBytes = uint32(m_frameArena.getUsed());
+	stats.arenaPeakBytes = uint32(m_frameArena.getPeak());
+	m_visibleArrows = {};
+	m_visibleSpheres = {};
+	m_visibleTransforms = {};
+	m_frameArena.reset();
+
+	std::scoped_lock lock(m_statsMutex);
+	m_frameStats = stats;
+}
+
+// Adds the group's shapes to the visible lists, either from its spatial grids or all of them
+void DebugDrawManager::collectVisible(DebugGroup& group, FrameStats& stats) {
+	if ( !m_camera.culling ) {
+		for ( DebugArrow& arrow : group.arrows )
+			m_visibleArrows.push_back(&arrow);
+		for ( DebugSphere& sphere : group.spheres )
+			m_visibleSpheres.push_back(&sphere);
+		for ( DebugTransform& transform : group.transforms )
+			m_visibleTransforms.push_back(&transform);
+		return;
+	}
+
+	uint64 visibleBefore = m_visibleArrows.size() + m_visibleSpheres.size() + m_visibleTransforms.size();
+	group.gridArrows.query(m_camera.frustum, [&](uint64 key) {m_visibleArrows.push_back(group.arrows.find(key));});
+	group.gridSpheres.query(m_camera.frustum, [&](uint64 key) {m_visibleSpheres.push_back(group.spheres.find(key));});
+	group.gridTransforms.query(m_camera.frustum, [&](uint64 key) {m_visibleTransforms.push_back(group.transforms.find(key));});
+	uint64 visible = m_visibleArrows.size() + m_visibleSpheres.size() + m_visibleTransforms.size() - visibleBefore;
+	stats.culledShapes += group.arrows.size() + group.spheres.size() + group.transforms.size() - uint32(visible);
 }
 
-void DebugDrawManager::addArrow(const std::string_view& name, const Vec3& begin, const Vec3& end, u8Vec3 color) {
+// Regenerates the dirty shapes among the visible ones in [begin, end), safe to run on several threads for disjoint ranges
+void DebugDrawManager::regenerateShapes(uint32 begin, uint32 end) {
+	uint32 sphereBegin = uint32(m_visibleArrows.size());
+	uint32 transformBegin = sphereBegin + uint32(m_visibleSpheres.size());
+
+	for ( uint32 i = begin; i < end && i < sphereBegin; ++i ) {
+		DebugArrow& arrow = *m_visibleArrows[i];
+		if ( arrow.dirty ) {
+			GenerateArrow(arrow);
+			arrow.dirty = false;
+		}
+	}
+
+	for ( uint32 i = max(begin, sphereBegin); i < end && i < transformBegin; ++i ) {
+		DebugSphere& sphere = *m_visibleSpheres[i - sphereBegin];
+		// The level changes with the camera, or when the camera is reset
+		uint8 level = getSphereLevel(sphere.position, sphere.radius);
+		if ( level != sphere.level ) {
+			sphere.level = level;
+			sphere.dirty = true;
+		}
+		if ( sphere.dirty ) {
+			GenerateSphere(sphere, m_arrBaseSphereLevels[sphere.level]);
+			sphere.dirty = false;
+		}
+	}
+
+	for ( uint32 i = max(begin, transformBegin); i < end; ++i ) {
+		DebugTransform& transform = *m_visibleTransforms[i - transformBegin];
+		if ( transform.dirty ) {
+			GenerateTransform(transform);
+			transform.dirty = false;
+		}
+	}
+}
+
+// Copies the cached vertices of the visible shapes in [begin, end) to their place in pVertices,
+// which holds all arrows, then all spheres, then all transforms
+void DebugDrawManager::copyShapes(LineVertex* pVertices, const uint32* pArrSphereOffsets, uint32 begin, uint32 end) const {
+	uint32 sphereBegin = uint32(m_visibleArrows.size());
+	uint32 transformBegin = sphereBegin + uint32(m_visibleSpheres.size());
+	LineVertex* pSphereVertices = pVertices + sphereBegin * ArrowVertexCount;
+	LineVertex* pTransformVertices = pSphereVertices;
+	if ( transformBegin != sphereBegin ) {
+		const DebugSphere* pLastSphere = m_visibleSpheres[transformBegin - sphereBegin - 1];
+		pTransformVertices += pArrSphereOffsets[transformBegin - sphereBegin - 1] + pLastSphere->vertices.size();
+	}
+
+	for ( uint32 i = begin; i < end && i < sphereBegin; ++i )
+		memcpy(pVertices + i * ArrowVertexCount, m_visibleArrows[i]->vertices.data(), ArrowVertexCount * sizeof(LineVertex));
+
+	for ( uint32 i = max(begin, sphereBegin); i < end && i < transformBegin; ++i ) {
+		const DebugSphere& sphere = *m_visibleSpheres[i - sphereBegin];
+		memcpy(pSphereVertices + pArrSphereOffsets[i - sphereBegin], sphere.vertices.data(), sphere.vertices.size() * sizeof(LineVertex));
+	}
+
+	for ( uint32 i = max(begin, transformBegin); i < end; ++i ) {
+		uint32 index = i - transformBegin;
+		memcpy(pTransformVertices + index * TransformVertexCount, m_visibleTransforms[index]->vertices.data(), TransformVertexCount * sizeof(LineVertex));
+	}
+}
+
+void DebugDrawManager::stopWorkers() {
+	std::scoped_lock lock(m_workerPoolMutex);
+	m_pWorkerPool.reset();
+}
+
+void DebugDrawManager::abandonWorkers() {
+	// Threads of a terminating process are already gone, otherwise they stay blocked on the leaked pool.
+	// The mutex isn't taken, the render thread may have been terminated while holding it.
+	(void)m_pWorkerPool.release();
+}
+
+DebugDrawManager::FrameStats DebugDrawManager::getFrameStats() {
+	std::scoped_lock lock(m_statsMutex);
+	return m_frameStats;
+}
+
+void DebugDrawManager::emitWithBudget(DebugDrawer* pDrawer, uint32 budget, FrameStats& stats) {
+	uint32 remaining = budget;
+	uint32 reducedSphereVertexCount = uint32(m_arrBaseSphereLevels[0].getLines().size() * 2);
+	// Shared by all reduced spheres, the drawer copies the vertices right away
+	LineVertex* pReducedSphereVertices = nullptr;
+
+	for ( int32 p = int32(DebugDrawPriority::High); p >= int32(DebugDrawPriority::Low); --p ) {
+		DebugDrawPriority priority = DebugDrawPriority(p);
+
+		for ( const DebugArrow* pArrow : m_visibleArrows ) {
+			if ( pArrow->priority != priority )
+				continue;
+			if ( remaining < ArrowVertexCount ) {
+				++stats.droppedShapes;
+				continue;
+			}
+			pDrawer->drawVertices(pArrow->vertices.data(), ArrowVertexCount);
+			remaining -= ArrowVertexCount;
+		}
+
+		for ( const DebugSphere* pSphere : m_visibleSpheres ) {
+			const DebugSphere& sphere = *pSphere;
+			if ( sphere.priority != priority )
+				continue;
+			uint32 count = uint32(sphere.vertices.size());
+			if ( remaining >= count ) {
+				pDrawer->drawVertices(sphere.vertices.data(), count);
+				remaining -= count;
+			} else if ( sphere.level > 0 && remaining >= reducedSphereVertexCount ) {
+				// Fall back to the lowest detail level
+				if ( pReducedSphereVertices == nullptr )
+					pReducedSphereVertices = m_frameArena.allocate<LineVertex>(reducedSphereVertexCount);
+				GenerateSphere(
+					pReducedSphereVertices, sphere.position, sphere.radius, ToLineVertexColor(sphere.color), m_arrBaseSphereLevels[0]
+				);
+				pDrawer->drawVertices(pReducedSphereVertices, reducedSphereVertexCount);
+				remaining -= reducedSphereVertexCount;
+				++stats.reducedSpheres;
+			} else
+				++stats.droppedShapes;
+		}
+
+		for ( const DebugTransform* pTransform : m_visibleTransforms ) {
+			if ( pTransform->priority != priority )
+				continue;
+			if ( remaining < TransformVertexCount ) {
+				++stats.droppedShapes;
+				continue;
+			}
+			pDrawer->drawVertices(pTransform->vertices.data(), TransformVertexCount);
+			remaining -= TransformVertexCount;
+		}
+
+		// Lines don't have a name to set their priority by
+		if ( priority != DebugDrawPriority::Normal )
+			continue;
+		for ( const DebugLine& line : m_mapLines ) {
+			if ( remaining < 2 ) {
+				++stats.droppedShapes;
+				continue;
+			}
+			pDrawer->drawVertices(line.vertices.data(), 2);
+			remaining -= 2;
+		}
+	}
+
+	stats.emittedVertices = budget - remaining;
+}
+
+void DebugDrawManager::addArrow(const std::string_view& name, const Vec3& begin, const Vec3& end, u8Vec3 color, uint32 group, float lifetime) {
 	if ( !m_bEnabled )
 		return;
-	uint32 hash = XXH32(name.data(), name.size(), 0);
-	std::scoped_lock lock(m_mutex);
-	auto it = m_mapArrows.find(hash);
-	if ( it == m_mapArrows.end() )
-		return (void)m_mapArrows.emplace(hash, DebugArrow(std::string(name), begin, end, color));
+	Command cmd = {
+		.type = CommandType::AddArrow, .group = group, .hash = HashName(name), .position = begin, .vector = end, .color = color, .lifetime = lifetime
+	};
+	pushCommand(cmd, name);
+}
 
-	DebugArrow& elem = it->second;
-	elem.begin = begin;
-	elem.end = end;
-	elem.color = color;
+void DebugDrawManager::addSphere(const std::string_view& name, const Vec3& position, float radius, u8Vec3 color, uint32 group, float lifetime) {
+	if ( !m_bEnabled )
+		return;
+	Command cmd = {
+		.type = CommandType::AddSphere, .group = group, .hash = HashName(name), .position = position, .radius = radius, .color = color, .lifetime = lifetime
+	};
+	pushCommand(cmd, name);
 }
 
-void DebugDrawManager::addSphere(const std::string_view& name, const Vec3& position, float radius, u8Vec3 color) {
+void DebugDrawManager::addTransform(
+	const std::string_view& name, const Vec3& origin, const Quat& rotation, const Vec3& scale, uint32 group, float lifetime
+) {
 	if ( !m_bEnabled )
 		return;
-	uint32 hash = XXH32(name.data(), name.size(), 0);
-	std::scoped_lock lock(m_mutex);
-	auto it = m_mapSpheres.find(hash);
-	if ( it == m_mapSpheres.end() )
-		return (void)m_mapSpheres.emplace(
-			hash, DebugSphere(std::string(name), position, radius, color, IcoSphere(GetSphereSizeLevel(radius), Vec3(radius)))
-		);
+	Command cmd = {
+		.type = CommandType::AddTransform, .group = group, .hash = HashName(name), .position = origin, .vector = scale, .rotation = rotation, .lifetime = lifetime
+	};
+	pushCommand(cmd, name);
+}
 
-	DebugSphere& elem = it->second;
-	elem.position = position;
-	elem.color = color;
-	if ( radius != elem.radius ) {
-		elem.radius = radius;
-		elem.shape = IcoSphere(GetSphereSizeLevel(radius), Vec3(radius));
-	}
+void DebugDrawManager::addLine(const Vec3& begin, const Vec3& end, u8Vec3 color, float lifetime) {
+	if ( !m_bEnabled || lifetime <= 0.0f )
+		return;
+	Command cmd = {.type = CommandType::AddLine, .position = begin, .vector = end, .color = color, .lifetime = lifetime};
+	pushCommand(cmd);
+}
+
+void DebugDrawManager::drawLine(const Vec3& begin, const Vec3& end, u8Vec3 color, uint32 frames) {
+	u8Vec4 vertexColor = ToLineVertexColor(color);
+	LineVertex vertices[2] = {{begin, vertexColor}, {end, vertexColor}};
+	drawLines(vertices, 2, frames);
+}
+
+void DebugDrawManager::drawLines(const LineVertex* pVertices, uint32 count, uint32 frames) {
+	if ( !m_bEnabled || count == 0 || frames == 0 )
+		return;
+	frames = min(frames, MaxLineFrames);
+	Producer producer(m_producers);
+	ProducerBuffers& buffers = producer.getBuffers();
+	// Bounds the memory used while render() isn't running, e.g. while the game is minimized
+	if ( buffers.lineVertices.size() + count > MaxStagedLineVertices )
+		return;
+	// The batch is counted last, so vertices and batches still match if either allocation throws
+	uint64 clearCount = m_lineClearCount.load(std::memory_order_relaxed);
+	if ( buffers.lineBatches.empty() || buffers.lineBatches.back().frames != frames || buffers.lineBatches.back().clearCount != clearCount )
+		buffers.lineBatches.emplace_back(0, frames, clearCount);
+	buffers.lineVertices.insert(buffers.lineVertices.end(), pVertices, pVertices + count);
+	buffers.lineBatches.back().vertexCount += count;
 }
 
-void DebugDrawManager::addTransform(const std::string_view& name, const Vec3& origin, const Quat& rotation, const Vec3& scale) {
+void DebugDrawManager::clear(const std::string_view& name, uint32 group) {
 	if ( !m_bEnabled )
 		return;
-	uint32 hash = XXH32(name.data(), name.size(), 0);
-	std::scoped_lock lock(m_mutex);
-	auto it = m_mapTransforms.find(hash);
-	if ( it == m_mapTransforms.end() )
-		return (void)m_mapTransforms.emplace(hash, DebugTransform(std::string(name), origin, rotation, scale));
+	Command cmd = {.type = CommandType::Clear, .group = group};
+	// Lines this thread staged before a full clear are dropped with it, the ones staged after it are kept
+	if ( group == DefaultGroup && name.empty() )
+		cmd.hash = m_lineClearCount.fetch_add(1, std::memory_order_relaxed) + 1;
+	pushCommand(cmd, name);
+}
 
-	DebugTransform& elem = it->second;
-	elem.origin = origin;
-	elem.rotation = rotation;
-	elem.scale = scale;
+void DebugDrawManager::removeArrow(const std::string_view& name, uint32 group) {
+	if ( !m_bEnabled )
+		return;
+	Command cmd = {.type = CommandType::RemoveArrow, .group = group, .hash = HashName(name)};
+	pushCommand(cmd, name);
 }
 
-void DebugDrawManager::clear(const std::string_view& name) {
-	std::scoped_lock lock(m_mutex);
-	if ( name.empty() ) {
-		m_mapArrows.clear();
-		m_mapSpheres.clear();
-		m_mapTransforms.clear();
+void DebugDrawManager::removeSphere(const std::string_view& name, uint32 group) {
+	if ( !m_bEnabled )
+		return;
+	Command cmd = {.type = CommandType::RemoveSphere, .group = group, .hash = HashName(name)};
+	pushCommand(cmd, name);
+}
+
+void DebugDrawManager::removeTransform(const std::string_view& name, uint32 group) {
+	if ( !m_bEnabled )
+		return;
+	Command cmd = {.type = CommandType::RemoveTransform, .group = group, .hash = HashName(name)};
+	pushCommand(cmd, name);
+}
+
+uint32 DebugDrawManager::getGroupId(const std::string_view& name) {
+	std::scoped_lock lock(m_groupIdsMutex);
+	auto [it, bInserted] = m_mapGroupIds.try_emplace(std::string(name), m_nextGroupId);
+	if ( bInserted )
+		++m_nextGroupId;
+	return it->second;
+}
+
+void DebugDrawManager::setGroupVisible(uint32 group, bool visible) {
+	if ( !m_bEnabled )
+		return;
+	Command cmd = {.type = CommandType::SetGroupVisible, .group = group, .visible = visible};
+	pushCommand(cmd);
+}
+
+void DebugDrawManager::setArrow(uint32 handle, const Vec3& begin, const Vec3& end, u8Vec3 color) {
+	if ( !m_bEnabled )
+		return;
+	Command cmd = {.type = CommandType::SetArrowHandle, .hash = handle, .position = begin, .vector = end, .color = color};
+	pushCommand(cmd);
+}
+
+void DebugDrawManager::setSphere(uint32 handle, const Vec3& position, float radius, u8Vec3 color) {
+	if ( !m_bEnabled )
 		return;
+	Command cmd = {.type = CommandType::SetSphereHandle, .hash = handle, .position = position, .radius = radius, .color = color};
+	pushCommand(cmd);
+}
+
+void DebugDrawManager::setTransform(uint32 handle, const Vec3& origin, const Quat& rotation, const Vec3& scale) {
+	if ( !m_bEnabled )
+		return;
+	Command cmd = {.type = CommandType::SetTransformHandle, .hash = handle, .position = origin, .vector = scale, .rotation = rotation};
+	pushCommand(cmd);
+}
+
+void DebugDrawManager::removeHandle(uint32 handle) {
+	if ( !m_bEnabled )
+		return;
+	Command cmd = {.type = CommandType::RemoveHandle, .hash = handle};
+	pushCommand(cmd);
+}
+
+void DebugDrawManager::setPriority(const std::string_view& prefix, DebugDrawPriority priority) {
+	if ( !m_bEnabled )
+		return;
+	Command cmd = {.type = CommandType::SetPriority, .priority = priority};
+	pushCommand(cmd, prefix);
+}
+
+void DebugDrawManager::setCamera(const Vec3& position, float fov, const Vec3& direction, float aspect) {
+	std::scoped_lock lock(m_cameraMutex);
+	m_pendingCamera = {true, position, fov, direction, aspect};
+}
+
+void DebugDrawManager::resetCamera() {
+	std::scoped_lock lock(m_cameraMutex);
+	m_pendingCamera.valid = false;
+}
+
+void DebugDrawManager::pushCommand(Command& cmd, const std::string_view& name) {
+	Producer producer(m_producers);
+	ProducerBuffers& buffers = producer.getBuffers();
+	if ( coalesceCommand(buffers, cmd, name) )
+		return;
+	cmd.sequence = m_nextCommandSequence.fetch_add(1, std::memory_order_relaxed);
+	cmd.nameOffset = uint32(buffers.names.size());
+	cmd.nameLength = uint32(name.size());
+	buffers.names.append(name);
+	buffers.commands.push_back(cmd);
+	// Only remembered once the command was queued, the index must never point past the commands if pushing throws
+	if ( isCoalescable(cmd.type) )
+		buffers.mapPendingShapes[getPendingShapeKey(cmd)] = uint32(buffers.commands.size() - 1);
+}
+
+// Overwrites the data of a pending add or set of the same shape instead of queueing another command.
+// The merged command takes a new sequence number, so it's still applied after whatever other threads pushed in the meantime,
+// e.g. a clear or a remove of the same shape. Among this thread's own commands it keeps its place, which only matches some order
+// the calls could have been applied in as long as none of the commands in between touch the same shape, so anything but adds,
+// sets and lines stops coalescing.
+bool DebugDrawManager::coalesceCommand(ProducerBuffers& buffers, Command& cmd, const std::string_view& name) {
+	if ( !isCoalescable(cmd.type) ) {
+		if ( cmd.type != CommandType::AddLine )
+			buffers.mapPendingShapes.clear();
+		return false;
 	}
-	{
-		auto it = m_mapArrows.begin();
-		while ( it != m_mapArrows.end() ) {
-			if ( it->second.name.starts_with(name) )
-				it = m_mapArrows.erase(it);
-			else
-				++it;
+
+	auto it = buffers.mapPendingShapes.find(getPendingShapeKey(cmd));
+	if ( it == buffers.mapPendingShapes.end() )
+		return false;
+	Command& pending = buffers.commands[it->second];
+	if (
+		pending.type != cmd.type || pending.group != cmd.group || pending.hash != cmd.hash
+		|| std::string_view(buffers.names.data() + pending.nameOffset, pending.nameLength) != name
+	)
+		return false;
+	cmd.sequence = m_nextCommandSequence.fetch_add(1, std::memory_order_relaxed);
+	cmd.nameOffset = pending.nameOffset;
+	cmd.nameLength = pending.nameLength;
+	pending = cmd;
+	return true;
+}
+
+// Adds and sets of the same shape replace each other's data, lines don't touch other shapes
+bool DebugDrawManager::isCoalescable(CommandType type) {
+	switch ( type ) {
+		case CommandType::AddArrow:
+		case CommandType::AddSphere:
+		case CommandType::AddTransform:
+		case CommandType::SetArrowHandle:
+		case CommandType::SetSphereHandle:
+		case CommandType::SetTransformHandle:
+			return true;
+		default:
+			return false;
+	}
+}
+
+uint64 DebugDrawManager::getPendingShapeKey(const Command& cmd) {
+	return cmd.hash ^ (uint64(cmd.group) << 32) ^ (uint64(cmd.type) << 56);
+}
+
+void DebugDrawManager::applyCommands() {
+	// Each thread's commands are in order already
+	ProducerBuffers* pSingle = nullptr;
+	uint32 producerCount = 0;
+	uint64 commandCount = 0;
+	uint64 firstSequence = ~uint64(0);
+	uint64 lastSequence = 0;
+	m_producers.forEachTaken([&](ProducerBuffers& buffers) {
+		if ( buffers.commands.empty() )
+			return;
+		pSingle = &buffers;
+		++producerCount;
+		commandCount += buffers.commands.size();
+		// Merged commands took a new sequence number, so the buffer isn't sorted by them
+		for ( const Command& cmd : buffers.commands ) {
+			firstSequence = min(firstSequence, cmd.sequence);
+			lastSequence = max(lastSequence, cmd.sequence);
+		}
+	});
+
+	if ( producerCount == 1 ) {
+		for ( const Command& cmd : pSingle->commands )
+			applyCommand(cmd, std::string_view(pSingle->names.data() + cmd.nameOffset, cmd.nameLength));
+	} else if ( producerCount > 1 ) {
+		// Give every command its slot by sequence number.
+		// Gaps are left by commands pushed into the other buffers while the epoch advanced, and by the old numbers of merged
+		// commands. Once they would make up most of the slots, sorting the commands is cheaper.
+		struct OrderedCommand {
+			const Command* pCmd;
+			const char* pNames;
+		};
+		uint64 slotCount = lastSequence - firstSequence + 1;
+		OrderedCommand* pOrder;
+		if ( slotCount <= commandCount * 2 ) {
+			pOrder = m_frameArena.allocate<OrderedCommand>(slotCount);
+			std::fill_n(pOrder, slotCount, OrderedCommand{});
+			m_producers.forEachTaken([&](ProducerBuffers& buffers) {
+				for ( const Command& cmd : buffers.commands )
+					pOrder[cmd.sequence - firstSequence] = {&cmd, buffers.names.data()};
+			});
+		} else {
+			slotCount = commandCount;
+			pOrder = m_frameArena.allocate<OrderedCommand>(slotCount);
+			OrderedCommand* pNext = pOrder;
+			m_producers.forEachTaken([&](ProducerBuffers& buffers) {
+				for ( const Command& cmd : buffers.commands )
+					*pNext++ = {&cmd, buffers.names.data()};
+			});
+			std::sort(pOrder, pOrder + slotCount, [](const OrderedCommand& a, const OrderedCommand& b) {return a.pCmd->sequence < b.pCmd->sequence;});
+		}
+		for ( uint64 i = 0; i < slotCount; ++i ) {
+			const Command* pCmd = pOrder[i].pCmd;
+			if ( pCmd != nullptr )
+				applyCommand(*pCmd, std::string_view(pOrder[i].pNames + pCmd->nameOffset, pCmd->nameLength));
 		}
 	}
-	{
-		auto it = m_mapSpheres.begin();
-		while ( it != m_mapSpheres.end() ) {
-			if ( it->second.name.starts_with(name) )
-				it = m_mapSpheres.erase(it);
-			else
-				++it;
+
+	// Keep the capacity around for the next time the buffers are used
+	m_producers.forEachTaken([](ProducerBuffers& buffers) {
+		buffers.commands.clear();
+		buffers.names.clear();
+		buffers.mapPendingShapes.clear();
+	});
+}
+
+void DebugDrawManager::applyCommand(const Command& cmd, const std::string_view& name) {
+	DebugGroup* pGroup = nullptr;
+	switch ( cmd.type ) {
+		case CommandType::AddArrow:
+			applyAddArrow(getGroup(cmd.group), cmd, name);
+			break;
+		case CommandType::AddSphere:
+			applyAddSphere(getGroup(cmd.group), cmd, name);
+			break;
+		case CommandType::AddTransform:
+			applyAddTransform(getGroup(cmd.group), cmd, name);
+			break;
+		case CommandType::RemoveArrow:
+			if ( (pGroup = findGroup(cmd.group)) != nullptr )
+				applyRemoveArrow(*pGroup, cmd.hash, name);
+			break;
+		case CommandType::RemoveSphere:
+			if ( (pGroup = findGroup(cmd.group)) != nullptr )
+				applyRemoveSphere(*pGroup, cmd.hash, name);
+			break;
+		case CommandType::RemoveTransform:
+			if ( (pGroup = findGroup(cmd.group)) != nullptr )
+				applyRemoveTransform(*pGroup, cmd.hash, name);
+			break;
+		case CommandType::Clear:
+			if ( cmd.group == DefaultGroup && name.empty() ) {
+				for ( auto& [id, pClearGroup] : m_mapGroups )
+					applyClear(*pClearGroup, name);
+				m_mapLines.clear();
+				m_timers.clear();
+				// Lines staged in earlier frames are all older than the clear, the ones taken this frame are filtered by takeStagedLines
+				m_vecLineVertices.clear();
+				m_vecLineBatches.clear();
+				m_appliedLineClearCount = max(m_appliedLineClearCount, cmd.hash);
+			} else if ( (pGroup = findGroup(cmd.group)) != nullptr )
+				applyClear(*pGroup, name);
+			break;
+		case CommandType::SetPriority:
+			applySetPriority(name, cmd.priority);
+			break;
+		case CommandType::SetGroupVisible:
+			getGroup(cmd.group).visible = cmd.visible;
+			break;
+		case CommandType::SetArrowHandle:
+			applyAddArrow(m_handleShapes, cmd, name);
+			break;
+		case CommandType::SetSphereHandle:
+			applyAddSphere(m_handleShapes, cmd, name);
+			break;
+		case CommandType::SetTransformHandle:
+			applyAddTransform(m_handleShapes, cmd, name);
+			break;
+		case CommandType::AddLine:
+			applyAddLine(cmd);
+			break;
+		case CommandType::RemoveHandle:
+			applyRemoveHandle(cmd.hash);
+			break;
+	}
+}
+
+void DebugDrawManager::takeStagedLines() {
+	m_producers.forEachTaken([this](ProducerBuffers& buffers) {
+		// A thread's batches are in the order it staged them, so the ones staged before the last full clear come first
+		uint32 clearedBatches = 0;
+		uint32 clearedVertices = 0;
+		while ( clearedBatches < buffers.lineBatches.size() && buffers.lineBatches[clearedBatches].clearCount < m_appliedLineClearCount )
+			clearedVertices += buffers.lineBatches[clearedBatches++].vertexCount;
+		m_vecLineVertices.insert(m_vecLineVertices.end(), buffers.lineVertices.begin() + clearedVertices, buffers.lineVertices.end());
+		m_vecLineBatches.insert(m_vecLineBatches.end(), buffers.lineBatches.begin() + clearedBatches, buffers.lineBatches.end());
+		buffers.lineVertices.clear();
+		buffers.lineBatches.clear();
+	});
+}
+
+// Drops the lines whose frame count ran out, moving the remaining ones to the front
+void DebugDrawManager::retireDrawnLines() {
+	uint32 readOffset = 0;
+	uint32 writeOffset = 0;
+	uint32 batchCount = 0;
+	for ( LineBatch& batch : m_vecLineBatches ) {
+		if ( --batch.frames != 0 ) {
+			if ( readOffset != writeOffset )
+				std::copy_n(m_vecLineVertices.begin() + readOffset, batch.vertexCount, m_vecLineVertices.begin() + writeOffset);
+			writeOffset += batch.vertexCount;
+			m_vecLineBatches[batchCount++] = batch;
 		}
+		readOffset += batch.vertexCount;
 	}
-	{
-		auto it = m_mapTransforms.begin();
-		while ( it != m_mapTransforms.end() ) {
-			if ( it->second.name.starts_with(name) )
-				it = m_mapTransforms.erase(it);
-			else
-				++it;
+	m_vecLineVertices.resize(writeOffset);
+	m_vecLineBatches.resize(batchCount);
+}
+
+DebugGroup& DebugDrawManager::getGroup(uint32 group) {
+	std::unique_ptr<DebugGroup>& pGroup = m_mapGroups[group];
+	if ( pGroup == nullptr )
+		pGroup = std::make_unique<DebugGroup>();
+	return *pGroup;
+}
+
+DebugGroup* DebugDrawManager::findGroup(uint32 group) {
+	auto it = m_mapGroups.find(group);
+	return (it != m_mapGroups.end() ? it->second.get() : nullptr);
+}
+
+void DebugDrawManager::applyAddArrow(DebugGroup& group, const Command& cmd, const std::string_view& name) {
+	uint64 key = cmd.hash;
+	DebugArrow* pElem = (&group == &m_handleShapes ? group.arrows.find(key) : FindShape(group, group.arrows, name, key));
+	if ( pElem == nullptr ) {
+		BoundingSphere bounds = GetArrowBounds(cmd.position, cmd.vector, ArrowHeadLength);
+		DebugArrow& elem = group.arrows.insert(key, DebugArrow(
+			acquireName(group, name, key, ArrowBit), cmd.position, cmd.vector, cmd.color, getPriority(name), bounds
+		));
+		group.gridArrows.insert(key, bounds);
+		setExpiry(elem.expireTick, elem.timerTick, cmd, ArrowBit, key);
+		return;
+	}
+
+	DebugArrow& elem = *pElem;
+	setExpiry(elem.expireTick, elem.timerTick, cmd, ArrowBit, key);
+	if ( elem.begin == cmd.position && elem.end == cmd.vector && elem.color == cmd.color )
+		return;
+	elem.begin = cmd.position;
+	elem.end = cmd.vector;
+	elem.color = cmd.color;
+	elem.bounds = GetArrowBounds(cmd.position, cmd.vector, ArrowHeadLength);
+	elem.dirty = true;
+	group.gridArrows.update(key, elem.bounds);
+}
+
+void DebugDrawManager::applyAddSphere(DebugGroup& group, const Command& cmd, const std::string_view& name) {
+	uint64 key = cmd.hash;
+	DebugSphere* pElem = (&group == &m_handleShapes ? group.spheres.find(key) : FindShape(group, group.spheres, name, key));
+	if ( pElem == nullptr ) {
+		DebugSphere& elem = group.spheres.insert(key, DebugSphere(
+			acquireName(group, name, key, SphereBit), cmd.position, cmd.radius, cmd.color, getSphereLevel(cmd.position, cmd.radius), getPriority(name)
+		));
+		group.gridSpheres.insert(key, {cmd.position, cmd.radius});
+		setExpiry(elem.expireTick, elem.timerTick, cmd, SphereBit, key);
+		return;
+	}
+
+	DebugSphere& elem = *pElem;
+	setExpiry(elem.expireTick, elem.timerTick, cmd, SphereBit, key);
+	if ( elem.position == cmd.position && elem.radius == cmd.radius && elem.color == cmd.color )
+		return;
+	elem.position = cmd.position;
+	elem.radius = cmd.radius;
+	elem.color = cmd.color;
+	elem.level = getSphereLevel(cmd.position, cmd.radius);
+	elem.dirty = true;
+	group.gridSpheres.update(key, {cmd.position, cmd.radius});
+}
+
+void DebugDrawManager::applyAddTransform(DebugGroup& group, const Command& cmd, const std::string_view& name) {
+	uint64 key = cmd.hash;
+	DebugTransform* pElem = (&group == &m_handleShapes ? group.transforms.find(key) : FindShape(group, group.transforms, name, key));
+	if ( pElem == nullptr ) {
+		BoundingSphere bounds = GetTransformBounds(cmd.position, cmd.vector);
+		DebugTransform& elem = group.transforms.insert(key, DebugTransform(
+			acquireName(group, name, key, TransformBit), cmd.position, cmd.rotation, cmd.vector, getPriority(name), bounds
+		));
+		group.gridTransforms.insert(key, bounds);
+		setExpiry(elem.expireTick, elem.timerTick, cmd, TransformBit, key);
+		return;
+	}
+
+	DebugTransform& elem = *pElem;
+	setExpiry(elem.expireTick, elem.timerTick, cmd, TransformBit, key);
+	if ( elem.origin == cmd.position && elem.rotation == cmd.rotation && elem.scale == cmd.vector )
+		return;
+	elem.origin = cmd.position;
+	elem.rotation = cmd.rotation;
+	elem.scale = cmd.vector;
+	elem.bounds = GetTransformBounds(cmd.position, cmd.vector);
+	elem.dirty = true;
+	group.gridTransforms.update(key, elem.bounds);
+}
+
+void DebugDrawManager::applyRemoveArrow(DebugGroup& group, uint64 hash, const std::string_view& name) {
+	DebugArrow* pElem = FindShape(group, group.arrows, name, hash);
+	if ( pElem == nullptr )
+		return;
+	eraseArrow(group, hash, *pElem);
+}
+
+void DebugDrawManager::applyRemoveSphere(DebugGroup& group, uint64 hash, const std::string_view& name) {
+	DebugSphere* pElem = FindShape(group, group.spheres, name, hash);
+	if ( pElem == nullptr )
+		return;
+	eraseSphere(group, hash, *pElem);
+}
+
+void DebugDrawManager::applyRemoveTransform(DebugGroup& group, uint64 hash, const std::string_view& name) {
+	DebugTransform* pElem = FindShape(group, group.transforms, name, hash);
+	if ( pElem == nullptr )
+		return;
+	eraseTransform(group, hash, *pElem);
+}
+
+// Handles are unique across all shape kinds and have no names that could collide, so they are looked up directly
+void DebugDrawManager::applyRemoveHandle(uint64 handle) {
+	DebugArrow* pArrow = m_handleShapes.arrows.find(handle);
+	if ( pArrow != nullptr ) {
+		eraseArrow(m_handleShapes, handle, *pArrow);
+		return;
+	}
+	DebugSphere* pSphere = m_handleShapes.spheres.find(handle);
+	if ( pSphere != nullptr ) {
+		eraseSphere(m_handleShapes, handle, *pSphere);
+		return;
+	}
+	DebugTransform* pTransform = m_handleShapes.transforms.find(handle);
+	if ( pTransform != nullptr )
+		eraseTransform(m_handleShapes, handle, *pTransform);
+}
+
+void DebugDrawManager::applyAddLine(const Command& cmd) {
+	u8Vec4 color = ToLineVertexColor(cmd.color);
+	uint64 id = m_nextLineId++;
+	DebugLine& line = m_mapLines.insert(id, DebugLine());
+	GenerateLine(line.vertices.data(), cmd.position, cmd.vector, color);
+	setExpiry(line.expireTick, line.timerTick, cmd, LineBit, id);
+}
+
+void DebugDrawManager::eraseArrow(DebugGroup& group, uint64 key, const DebugArrow& arrow) {
+	releaseName(group, arrow.name, ArrowBit);
+	group.arrows.erase(key);
+	group.gridArrows.remove(key);
+}
+
+void DebugDrawManager::eraseSphere(DebugGroup& group, uint64 key, const DebugSphere& sphere) {
+	releaseName(group, sphere.name, SphereBit);
+	group.spheres.erase(key);
+	group.gridSpheres.remove(key);
+}
+
+void DebugDrawManager::eraseTransform(DebugGroup& group, uint64 key, const DebugTransform& transform) {
+	releaseName(group, transform.name, TransformBit);
+	group.transforms.erase(key);
+	group.gridTransforms.remove(key);
+}
+
+void DebugDrawManager::applyClear(DebugGroup& group, const std::string_view& name) {
+	// Dropping the group's containers doesn't touch any other group
+	if ( name.empty() ) {
+		group.arrows.clear();
+		group.spheres.clear();
+		group.transforms.clear();
+		group.names.clear();
+		group.gridArrows.clear();
+		group.gridSpheres.clear();
+		group.gridTransforms.clear();
+		return;
+	}
+
+	// Names sharing the prefix are sorted right after it
+	group.names.removePrefix(name, [&](const NamePool::Entry& entry) {
+		if ( entry.shapes & ArrowBit ) {
+			group.arrows.erase(entry.key);
+			group.gridArrows.remove(entry.key);
+		}
+		if ( entry.shapes & SphereBit ) {
+			group.spheres.erase(entry.key);
+			group.gridSpheres.remove(entry.key);
 		}
+		if ( entry.shapes & TransformBit ) {
+			group.transforms.erase(entry.key);
+			group.gridTransforms.remove(entry.key);
+		}
+	});
+}
+
+void DebugDrawManager::applySetPriority(const std::string_view& prefix, DebugDrawPriority priority) {
+	auto it = std::find_if(m_vecPriorityRules.begin(), m_vecPriorityRules.end(), [&](const auto& rule) {return rule.first == prefix;});
+	if ( it != m_vecPriorityRules.end() )
+		it->second = priority;
+	else
+		m_vecPriorityRules.emplace_back(std::string(prefix), priority);
+
+	// Existing shapes might be covered by a longer prefix, so look their priority up again
+	for ( auto& [groupId, pGroup] : m_mapGroups ) {
+		DebugGroup& group = *pGroup;
+		group.names.forEachPrefix(prefix, [&](uint32 id, const NamePool::Entry& entry) {
+			DebugDrawPriority namePriority = getPriority(group.names.get(id));
+			if ( entry.shapes & ArrowBit )
+				group.arrows.find(entry.key)->priority = namePriority;
+			if ( entry.shapes & SphereBit )
+				group.spheres.find(entry.key)->priority = namePriority;
+			if ( entry.shapes & TransformBit )
+				group.transforms.find(entry.key)->priority = namePriority;
+		});
+	}
+}
+
+void DebugDrawManager::setExpiry(uint64& expireTick, uint64& timerTick, const Command& cmd, ShapeBit shape, uint64 key) {
+	// A timer that is still scheduled finds the shape without expiry when it fires and drops itself
+	if ( cmd.lifetime <= 0.0f ) {
+		expireTick = 0;
+		return;
+	}
+	uint64 ticks = max(uint64(cmd.lifetime * TimerTicksPerSecond), uint64(1));
+	expireTick = m_timers.now() + ticks;
+
+	// Refreshing the lifetime keeps the scheduled timer, which moves itself to the new expiry when it fires
+	if ( timerTick != 0 && timerTick <= expireTick )
+		return;
+	timerTick = expireTick;
+	m_timers.schedule(expireTick, {shape, cmd.group, key});
+}
+
+// Returns whether the shape expired, otherwise its timer is scheduled again for the shape's current expiry if needed
+bool DebugDrawManager::checkExpiry(uint64 expireTick, uint64& timerTick, uint64 firedTick, const TimedShape& timed) {
+	// Left behind when the lifetime was shortened, the shape has an earlier timer already
+	if ( timerTick != firedTick )
+		return false;
+	if ( expireTick == 0 ) {
+		timerTick = 0;
+		return false;
 	}
+	if ( expireTick <= firedTick )
+		return true;
+	timerTick = expireTick;
+	m_timers.schedule(expireTick, timed);
+	return false;
+}
+
+void DebugDrawManager::expireShapes() {
+	// Timers of removed shapes are left behind, those don't find their shape anymore
+	m_timers.advance(GetTimeTick() - m_timeOrigin, [&](uint64 firedTick, const TimedShape& timed) {
+		if ( timed.shape == LineBit ) {
+			DebugLine* pLine = m_mapLines.find(timed.key);
+			if ( pLine != nullptr && checkExpiry(pLine->expireTick, pLine->timerTick, firedTick, timed) )
+				m_mapLines.erase(timed.key);
+			return;
+		}
+
+		DebugGroup* pGroup = findGroup(timed.group);
+		if ( pGroup == nullptr )
+			return;
+		switch ( timed.shape ) {
+			case ArrowBit: {
+				DebugArrow* pArrow = pGroup->arrows.find(timed.key);
+				if ( pArrow != nullptr && checkExpiry(pArrow->expireTick, pArrow->timerTick, firedTick, timed) )
+					eraseArrow(*pGroup, timed.key, *pArrow);
+				break;
+			}
+			case SphereBit: {
+				DebugSphere* pSphere = pGroup->spheres.find(timed.key);
+				if ( pSphere != nullptr && checkExpiry(pSphere->expireTick, pSphere->timerTick, firedTick, timed) )
+					eraseSphere(*pGroup, timed.key, *pSphere);
+				break;
+			}
+			case TransformBit: {
+				DebugTransform* pTransform = pGroup->transforms.find(timed.key);
+				if ( pTransform != nullptr && checkExpiry(pTransform->expireTick, pTransform->timerTick, firedTick, timed) )
+					eraseTransform(*pGroup, timed.key, *pTransform);
+				break;
+			}
+			default:
+				break;
+		}
+	});
+}
+
+uint32 DebugDrawManager::acquireName(DebugGroup& group, const std::string_view& name, uint64 key, ShapeBit shape) {
+	// Handle shapes don't have names
+	if ( &group == &m_handleShapes )
+		return NamePool::InvalidId;
+	uint32 id = group.names.find(name);
+	if ( id == NamePool::InvalidId )
+		id = group.names.add(name, key);
+	group.names[id].shapes |= shape;
+	return id;
+}
+
+void DebugDrawManager::releaseName(DebugGroup& group, uint32 id, ShapeBit shape) {
+	if ( id == NamePool::InvalidId )
+		return;
+	NamePool::Entry& entry = group.names[id];
+	entry.shapes &= ~shape;
+	if ( entry.shapes == 0 )
+		group.names.remove(id);
 }
 
-void DebugDrawManager::removeArrow(const std::string_view& name) {
-	uint32 hash = XXH32(name.data(), name.size(), 0);
-	std::scoped_lock lock(m_mutex);
-	m_mapArrows.erase(hash);
+DebugDrawPriority DebugDrawManager::getPriority(const std::string_view& name) const {
+	DebugDrawPriority priority = DebugDrawPriority::Normal;
+	uint64 matchLength = 0;
+	for ( const auto& [prefix, rulePriority] : m_vecPriorityRules ) {
+		if ( prefix.size() >= matchLength && name.starts_with(prefix) ) {
+			priority = rulePriority;
+			matchLength = prefix.size();
+		}
+	}
+	return priority;
 }
 
-void DebugDrawManager::removeSphere(const std::string_view& name) {
-	uint32 hash = XXH32(name.data(), name.size(), 0);
-	std::scoped_lock lock(m_mutex);
-	m_mapSpheres.erase(hash);
+uint8 DebugDrawManager::getSphereLevel(const Vec3& position, float radius) const {
+	if ( !m_camera.valid )
+		return GetSphereSizeLevel(radius);
+	return GetSphereProjectedLevel(radius, glm::distance(m_camera.position, position), m_camera.tanHalfFov);
 }
 
-void DebugDrawManager::removeTransform(const std::string_view& name) {
-	uint32 hash = XXH32(name.data(), name.size(), 0);
-	std::scoped_lock lock(m_mutex);
-	m_mapTransforms.erase(hash);
+void DebugDrawManager::updateCamera() {
+	PendingCamera pending;
+	{
+		std::scoped_lock lock(m_cameraMutex);
+		pending = m_pendingCamera;
+	}
+
+	m_camera.valid = pending.valid;
+	m_camera.culling = false;
+	if ( !pending.valid )
+		return;
+
+	float fov = glm::radians(glm::clamp(pending.fov, 1.0f, 179.0f));
+	m_camera.position = pending.position;
+	m_camera.tanHalfFov = glm::tan(fov * 0.5f);
+
+	float dirLength = glm::length(pending.direction);
+	if ( dirLength <= 0.0f || pending.aspect <= 0.0f )
+		return;
+	Vec3 dir = pending.direction / dirLength;
+	Vec3 up = UP;
+	if ( glm::abs(glm::dot(dir, up)) > 0.99f )
+		up = Vec3(0.0f, 1.0f, 0.0f);
+
+	Mat4 view = glm::lookAt(pending.position, pending.position + dir, up);
+	Mat4 projection = glm::perspective(fov, pending.aspect, CameraNearPlane, CameraFarPlane);
+	m_camera.frustum = Frustum(projection * view);
+	m_camera.culling = true;
 }
@@ -2,36 +2,121 @@
 
 #include <string_view>
 #include <string>
+#include <vector>
+#include <unordered_map>
+#include <array>
 #include <mutex>
+#include <atomic>
+#include <memory>
 
 #include "IcoSphere.hpp"
+#include "Frustum.hpp"
 #include "Types.hpp"
-#include "NullHash.hpp"
+#include "DenseMap.hpp"
+#include "SpatialGrid.hpp"
+#include "TimerWheel.hpp"
+#include "FrameArena.hpp"
+#include "NamePool.hpp"
+#include "WorkerPool.hpp"
+#include "ProducerQueues.hpp"
+#include "SM/LineVertexArray.hpp"
+
+namespace SM {
+	class DebugDrawer;
+}
+
+// Once the per-frame vertex budget is exceeded, higher priority shapes are drawn first
+enum class DebugDrawPriority : uint8 {
+	Low,
+	Normal,
+	High
+};
+
+// Shaft + 4 head lines
+constexpr uint32 ArrowVertexCount = 10;
+// 3 arrows
+constexpr uint32 TransformVertexCount = ArrowVertexCount * 3;
+
+// Each shape caches its generated line vertices, which are regenerated only when the shape is marked dirty
 
 struct DebugArrow {
-	std::string name;
+	uint32 name;	// Id in the group's name pool, NamePool::InvalidId for handle shapes
 	Vec3 begin;
 	Vec3 end;
 	u8Vec3 color;
+	DebugDrawPriority priority;
+	BoundingSphere bounds;
+	uint64 expireTick = 0;	// 0 if the shape doesn't expire
+	uint64 timerTick = 0;	// When the shape's timer fires, 0 if it has none. Only one timer per shape is kept scheduled.
+	bool dirty = true;
+	std::array<SM::LineVertex, ArrowVertexCount> vertices;
 };
 
 struct DebugSphere {
-	std::string name;
+	uint32 name;
 	Vec3 position;
 	float radius;
 	u8Vec3 color;
-	IcoSphere shape;
+	uint8 level;
+	DebugDrawPriority priority;
+	uint64 expireTick = 0;
+	uint64 timerTick = 0;
+	bool dirty = true;
+	std::vector<SM::LineVertex> vertices;
 };
 
 struct DebugTransform {
-	std::string name;
+	uint32 name;
 	Vec3 origin;
 	Quat rotation;
 	Vec3 scale;
+	DebugDrawPriority priority;
+	BoundingSphere bounds;
+	uint64 expireTick = 0;
+	uint64 timerTick = 0;
+	bool dirty = true;
+	std::array<SM::LineVertex, TransformVertexCount> vertices;
+};
+
+// Line added with a lifetime, unlike the single frame lines drawn directly
+struct DebugLine {
+	std::array<SM::LineVertex, 2> vertices;
+	uint64 expireTick;
+	uint64 timerTick = 0;
+};
+
+// Shapes are stored per group, so a whole group can be cleared or hidden at once
+struct DebugGroup {
+	DenseMap<uint64, DebugArrow> arrows;
+	DenseMap<uint64, DebugSphere> spheres;
+	DenseMap<uint64, DebugTransform> transforms;
+	NamePool names;
+
+	// Bounds of the stored shapes, queried when culling
+	SpatialGrid<uint64> gridArrows;
+	SpatialGrid<uint64> gridSpheres;
+	SpatialGrid<uint64> gridTransforms;
+
+	bool visible = true;
 };
 
 class DebugDrawManager {
 	public:
+		// Shapes added without a group
+		static constexpr uint32 DefaultGroup = 0;
+		// Staged lines are drawn for at most this many frames (a minute at 60 fps), longer ones are cut short
+		static constexpr uint32 MaxLineFrames = 3600;
+
+		// Statistics of the last rendered frame
+		struct FrameStats {
+			uint32 emittedVertices;
+			uint32 droppedShapes;
+			uint32 reducedSpheres;
+			uint32 culledShapes;
+			uint32 arenaUsedBytes;	// Transient memory used by the frame
+			uint32 arenaPeakBytes;	// Highest transient memory use of any frame
+		};
+
 		DebugDrawManager();
 		~DebugDrawManager();
 
@@ -39,23 +124,232 @@ class DebugDrawManager {
 
 		void render();
 
-		void addArrow(const std::string_view& name, const Vec3& begin, const Vec3& end, u8Vec3 color);
-		void addSphere(const std::string_view& name, const Vec3& position, float radius, u8Vec3 color);
-		void addTransform(const std::string_view& name, const Vec3& origin, const Quat& rotation, const Vec3& scale);
+		// Shapes with a lifetime (in seconds) above 0 are removed once it runs out, adding them again restarts it
+		void addArrow(const std::string_view& name, const Vec3& begin, const Vec3& end, u8Vec3 color, uint32 group = DefaultGroup, float lifetime = 0.0f);
+		void addSphere(const std::string_view& name, const Vec3& position, float radius, u8Vec3 color, uint32 group = DefaultGroup, float lifetime = 0.0f);
+		void addTransform(
+			const std::string_view& name, const Vec3& origin, const Quat& rotation, const Vec3& scale, uint32 group = DefaultGroup, float lifetime = 0.0f
+		);
+		// Lines always need a lifetime, they are only removed by expiring or clearing everything
+		void addLine(const Vec3& begin, const Vec3& end, u8Vec3 color, float lifetime);
+
+		// Unnamed lines drawn for the given number of frames, up to MaxLineFrames.
+		// They are staged per calling thread and handed to the drawer by render(), so callers never take the drawer lock.
+		// Clearing everything also drops the lines that are still drawn.
+		void drawLine(const Vec3& begin, const Vec3& end, u8Vec3 color, uint32 frames = 1);
+		void drawLines(const SM::LineVertex* pVertices, uint32 count, uint32 frames = 1);
+
+		// Clears all shapes of every group when called with an empty name on the default group
+		void clear(const std::string_view& name = "", uint32 group = DefaultGroup);
+
+		void removeArrow(const std::string_view& name, uint32 group = DefaultGroup);
+		void removeSphere(const std::string_view& name, uint32 group = DefaultGroup);
+		void removeTransform(const std::string_view& name, uint32 group = DefaultGroup);
+
+		// Every name gets its own id, which stays valid for as long as the manager exists. Never returns DefaultGroup.
+		uint32 getGroupId(const std::string_view& name);
+		void setGroupVisible(uint32 group, bool visible);
+
+		// Handles identify unnamed shapes, updating them skips hashing and storing a name.
+		// Setting a handle adds its shape if it doesn't exist yet. Handle shapes aren't affected by clear().
+		inline uint32 createHandle() {return m_nextHandle++;};
+		void setArrow(uint32 handle, const Vec3& begin, const Vec3& end, u8Vec3 color);
+		void setSphere(uint32 handle, const Vec3& position, float radius, u8Vec3 color);
+		void setTransform(uint32 handle, const Vec3& origin, const Quat& rotation, const Vec3& scale);
+		void removeHandle(uint32 handle);
 
-		void clear(const std::string_view& name = "");
+		// Sets the priority of all current and future shapes whose names start with the prefix.
+		// The longest matching prefix wins, shapes without a matching prefix have normal priority.
+		void setPriority(const std::string_view& prefix, DebugDrawPriority priority);
 
-		void removeArrow(const std::string_view& name);
-		void removeSphere(const std::string_view& name);
-		void removeTransform(const std::string_view& name);
+		// Maximum number of vertices emitted by render() per frame, 0 means unlimited
+		inline void setVertexBudget(uint32 budget) {m_vertexBudget = budget;};
+		// Number of threads render() generates and copies shape vertices on, including its own. 0 or 1 keeps it on the render thread.
+		inline void setWorkerThreads(uint32 count) {m_workerThreads = count;};
+		// Joins the worker threads, render() starts them again when it needs them.
+		// Never called from DllMain, the threads can't exit while it holds the loader lock.
+		void stopWorkers();
+		// Lets go of the worker threads without joining them, for DllMain once it's too late for stopWorkers()
+		void abandonWorkers();
+		FrameStats getFrameStats();
+
+		// Lets render() pick sphere detail levels by their size on screen instead of their radius.
+		// fov is the vertical field of view in degrees.
+		// With a direction, shapes outside of the view frustum are culled. aspect is the screen width divided by height.
+		void setCamera(const Vec3& position, float fov, const Vec3& direction = Vec3(0.0f), float aspect = 16.0f / 9.0f);
+		void resetCamera();
 
 	private:
+		enum class CommandType : uint8 {
+			AddArrow,
+			AddSphere,
+			AddTransform,
+			RemoveArrow,
+			RemoveSphere,
+			RemoveTransform,
+			Clear,
+			SetPriority,
+			SetGroupVisible,
+			SetArrowHandle,
+			SetSphereHandle,
+			SetTransformHandle,
+			RemoveHandle,
+			AddLine
+		};
+
+		// Queued by the add/remove/clear functions and applied at the start of render().
+		// Names (shape names for adds and removes, prefixes for clear and setPriority) are stored in a separate string buffer.
+		struct Command {
+			CommandType type;
+			uint32 group;
+			uint64 hash;	// Name hash or handle, for a full clear the number of full clears pushed up to and including it
+			uint64 sequence;	// Order the command was pushed in across all threads, renewed when an update is merged into it
+			uint32 nameOffset;
+			uint32 nameLength;
+			Vec3 position;	// Arrow begin, sphere position, transform origin
+			Vec3 vector;	// Arrow end, transform scale
+			Quat rotation;
+			float radius;
+			u8Vec3 color;
+			DebugDrawPriority priority;
+			bool visible;
+			float lifetime;
+		};
+
+		enum ShapeBit : uint8 {
+			ArrowBit = 1 << 0,
+			SphereBit = 1 << 1,
+			TransformBit = 1 << 2,
+			LineBit = 1 << 3
+		};
+
+		struct TimedShape {
+			ShapeBit shape;
+			uint32 group;
+			uint64 key;
+		};
+
+		// Consecutive staged vertices sharing the same frame count
+		struct LineBatch {
+			uint32 vertexCount;
+			uint32 frames;
+			uint64 clearCount;	// Full clears pushed before the vertices were staged
+		};
+
+		// Everything one producer thread pushed during one epoch
+		struct ProducerBuffers {
+			std::vector<Command> commands;
+			std::string names;
+			// Index of the latest add or set command per shape, repeated updates overwrite it instead of queueing another command
+			NullHashMap<uint64, uint32> mapPendingShapes;
+			std::vector<SM::LineVertex> lineVertices;
+			std::vector<LineBatch> lineBatches;
+		};
+		using Producer = ProducerQueues<ProducerBuffers>::Producer;
+
+		void pushCommand(Command& cmd, const std::string_view& name = "");
+		bool coalesceCommand(ProducerBuffers& buffers, Command& cmd, const std::string_view& name);
+		static bool isCoalescable(CommandType type);
+		static uint64 getPendingShapeKey(const Command& cmd);
+		void applyCommands();
+		void applyCommand(const Command& cmd, const std::string_view& name);
+
+		DebugGroup& getGroup(uint32 group);
+		DebugGroup* findGroup(uint32 group);
+
+		void applyAddArrow(DebugGroup& group, const Command& cmd, const std::string_view& name);
+		void applyAddSphere(DebugGroup& group, const Command& cmd, const std::string_view& name);
+		void applyAddTransform(DebugGroup& group, const Command& cmd, const std::string_view& name);
+		void applyAddLine(const Command& cmd);
+		void applyRemoveHandle(uint64 handle);
+		void applyRemoveArrow(DebugGroup& group, uint64 hash, const std::string_view& name);
+		void applyRemoveSphere(DebugGroup& group, uint64 hash, const std::string_view& name);
+		void applyRemoveTransform(DebugGroup& group, uint64 hash, const std::string_view& name);
+		void applyClear(DebugGroup& group, const std::string_view& name);
+		void eraseArrow(DebugGroup& group, uint64 key, const DebugArrow& arrow);
+		void eraseSphere(DebugGroup& group, uint64 key, const DebugSphere& sphere);
+		void eraseTransform(DebugGroup& group, uint64 key, const DebugTransform& transform);
+		void applySetPriority(const std::string_view& prefix, DebugDrawPriority priority);
+		void setExpiry(uint64& expireTick, uint64& timerTick, const Command& cmd, ShapeBit shape, uint64 key);
+		bool checkExpiry(uint64 expireTick, uint64& timerTick, uint64 firedTick, const TimedShape& timed);
+		void expireShapes();
+		uint32 acquireName(DebugGroup& group, const std::string_view& name, uint64 key, ShapeBit shape);
+		void releaseName(DebugGroup& group, uint32 id, ShapeBit shape);
+		void collectVisible(DebugGroup& group, FrameStats& stats);
+		DebugDrawPriority getPriority(const std::string_view& name) const;
+		uint8 getSphereLevel(const Vec3& position, float radius) const;
+		void updateCamera();
+
+		void regenerateShapes(uint32 begin, uint32 end);
+		void copyShapes(SM::LineVertex* pVertices, const uint32* pArrSphereOffsets, uint32 begin, uint32 end) const;
+		void emitWithBudget(SM::DebugDrawer* pDrawer, uint32 budget, FrameStats& stats);
+
+		void takeStagedLines();
+		void retireDrawnLines();
+
 		bool m_bEnabled = false;
 		IcoSphere m_arrBaseSphereLevels[3];
-		std::mutex m_mutex;
-		NullHashMap<uint32, DebugArrow> m_mapArrows;
-		NullHashMap<uint32, DebugSphere> m_mapSpheres;
-		NullHashMap<uint32, DebugTransform> m_mapTransforms;
+		std::atomic<uint32> m_vertexBudget = 0;
+		std::atomic<uint32> m_workerThreads = 0;
+		std::atomic<uint32> m_nextHandle = 1;
+
+		std::mutex m_statsMutex;
+		FrameStats m_frameStats = {};
+
+		struct PendingCamera {
+			bool valid = false;
+			Vec3 position;
+			float fov;
+			Vec3 direction;
+			float aspect;
+		};
+		std::mutex m_cameraMutex;
+		PendingCamera m_pendingCamera;
+
+		// Ids handed out by getGroupId, the groups themselves only exist while they have shapes or are hidden
+		std::mutex m_groupIdsMutex;
+		std::unordered_map<std::string, uint32> m_mapGroupIds;
+		uint32 m_nextGroupId = DefaultGroup + 1;
+
+		// One queue per producer thread, applyCommands and takeStagedLines read the buffers taken by render()
+		ProducerQueues<ProducerBuffers> m_producers;
+		// Commands of different threads are applied in the order of their sequence numbers
+		std::atomic<uint64> m_nextCommandSequence = 0;
+
+		// Staged lines taken by render(), kept until their frame count runs out
+		std::vector<SM::LineVertex> m_vecLineVertices;
+		std::vector<LineBatch> m_vecLineBatches;
+		// Full clears pushed and applied, staged batches drawn before the last applied one are dropped
+		std::atomic<uint64> m_lineClearCount = 0;
+		uint64 m_appliedLineClearCount = 0;
+
+		// Only accessed from the render thread
+		NullHashMap<uint32, std::unique_ptr<DebugGroup>> m_mapGroups;
+		// Shapes keyed by their handle, without names
+		DebugGroup m_handleShapes;
+		DenseMap<uint64, DebugLine> m_mapLines;
+		uint64 m_nextLineId = 0;
+		// Ticks are counted from m_timeOrigin
+		uint64 m_timeOrigin = 0;
+		TimerWheel<TimedShape> m_timers;
+		std::vector<std::pair<std::string, DebugDrawPriority>> m_vecPriorityRules;
+		struct {
+			bool valid = false;
+			Vec3 position;
+			float tanHalfFov;
+			bool culling = false;
+			Frustum frustum;
+		} m_camera;
+		// Transient data of render(), reset at the end of every frame
+		FrameArena m_frameArena;
+		// Shapes of the visible groups that passed culling this frame
+		FrameArray<DebugArrow*> m_visibleArrows;
+		FrameArray<DebugSphere*> m_visibleSpheres;
+		FrameArray<DebugTransform*> m_visibleTransforms;
+		// Recreated by render() when the requested thread count changes.
+		// The mutex is held by render() while it uses the pool and by stopWorkers().
+		std::mutex m_workerPoolMutex;
+		std::unique_ptr<WorkerPool> m_pWorkerPool;
 };
 
 extern DebugDrawManager* g_debugDrawManager;
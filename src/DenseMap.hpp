@@ -0,0 +1,74 @@
+#pragma once
+
+#include <vector>
+
+#include "NullHash.hpp"
+#include "Types.hpp"
+
+// Hash map storing its values contiguously, meant for fast iteration.
+// Keys map to indices into the value array, erasing swaps the last value into the freed slot.
+// Pointers and references to values are invalidated by inserting and erasing.
+template <typename K, typename V>
+class DenseMap {
+	public:
+		inline uint32 size() const {return uint32(m_vecValues.size());};
+		inline bool empty() const {return m_vecValues.empty();};
+
+		inline auto begin() {return m_vecValues.begin();};
+		inline auto end() {return m_vecValues.end();};
+		inline auto begin() const {return m_vecValues.begin();};
+		inline auto end() const {return m_vecValues.end();};
+
+		inline K getKey(uint32 index) const {return m_vecKeys[index];};
+		inline V& operator[](uint32 index) {return m_vecValues[index];};
+		inline const V& operator[](uint32 index) const {return m_vecValues[index];};
+
+		V* find(K key) {
+			auto it = m_mapIndices.find(key);
+			if ( it == m_mapIndices.end() )
+				return nullptr;
+			return &m_vecValues[it->second];
+		}
+
+		inline bool contains(K key) const {return m_mapIndices.contains(key);};
+
+		// Key must not already exist
+		V& insert(K key, V&& value) {
+			m_mapIndices.emplace(key, uint32(m_vecValues.size()));
+			m_vecKeys.push_back(key);
+			return m_vecValues.emplace_back(std::move(value));
+		}
+
+		bool erase(K key) {
+			auto it = m_mapIndices.find(key);
+			if ( it == m_mapIndices.end() )
+				return false;
+			uint32 index = it->second;
+			m_mapIndices.erase(it);
+			removeAt(index);
+			return true;
+		}
+
+		void clear() {
+			m_mapIndices.clear();
+			m_vecKeys.clear();
+			m_vecValues.clear();
+		}
+
+	private:
+		// Index must already be removed from m_mapIndices
+		void removeAt(uint32 index) {
+			uint32 last = uint32(m_vecValues.size() - 1);
+			if ( index != last ) {
+				m_vecValues[index] = std::move(m_vecValues[last]);
+				m_vecKeys[index] = m_vecKeys[last];
+				m_mapIndices[m_vecKeys[index]] = index;
+			}
+			m_vecValues.pop_back();
+			m_vecKeys.pop_back();
+		}
+
+		NullHashMap<K, uint32> m_mapIndices;
+		std::vector<K> m_vecKeys;
+		std::vector<V> m_vecValues;
+};
@@ -0,0 +1,81 @@
+#include "FFI_DebugDraw.hpp"
+#include "DebugDrawManager.hpp"
+#include "SM/Console.hpp"
+
+// Binds the C functions through FFI function pointers, which JIT traces can call directly.
+// Arguments: debugDraw table, followed by the function pointers as light userdata.
+static constexpr const char* FastPathSource = R"lua(
+local debugDraw, pDrawLine, pAddArrow, pAddSphere, pAddTransform = ...
+local ok, ffi = pcall(require, "ffi")
+if not ok or type(ffi) ~= "table" then
+	return false
+end
+
+local drawLine = ffi.cast("void(*)(float, float, float, float, float, float, uint32_t)", pDrawLine)
+local addArrow = ffi.cast("void(*)(const char*, uint32_t, float, float, float, float, float, float, uint32_t)", pAddArrow)
+local addSphere = ffi.cast("void(*)(const char*, uint32_t, float, float, float, float, uint32_t)", pAddSphere)
+local addTransform = ffi.cast("void(*)(const char*, uint32_t, float, float, float, float, float, float, float, float)", pAddTransform)
+
+debugDraw.fast = {
+	drawLine = function(x1, y1, z1, x2, y2, z2, color)
+		drawLine(x1, y1, z1, x2, y2, z2, color or 0xFFFFFF)
+	end,
+	addArrow = function(name, x1, y1, z1, x2, y2, z2, color)
+		addArrow(name, #name, x1, y1, z1, x2, y2, z2, color or 0xFFFFFF)
+	end,
+	addSphere = function(name, x, y, z, radius, color)
+		addSphere(name, #name, x, y, z, radius or 0.125, color or 0xFFFFFF)
+	end,
+	addTransform = function(name, x, y, z, qx, qy, qz, qw, scale)
+		addTransform(name, #name, x, y, z, qx, qy, qz, qw, scale or 1.0)
+	end
+}
+return true
+)lua";
+
+static u8Vec3 UnpackColor(uint32 color) {
+	return {uint8(color >> 16), uint8(color >> 8), uint8(color)};
+}
+
+
+
+void DebugDraw_DrawLine(float x1, float y1, float z1, float x2, float y2, float z2, uint32 color) {
+	g_debugDrawManager->drawLine({x1, y1, z1}, {x2, y2, z2}, UnpackColor(color));
+}
+
+void DebugDraw_AddArrow(const char* name, uint32 nameLength, float x1, float y1, float z1, float x2, float y2, float z2, uint32 color) {
+	g_debugDrawManager->addArrow({name, nameLength}, {x1, y1, z1}, {x2, y2, z2}, UnpackColor(color));
+}
+
+void DebugDraw_AddSphere(const char* name, uint32 nameLength, float x, float y, float z, float radius, uint32 color) {
+	g_debugDrawManager->addSphere({name, nameLength}, {x, y, z}, radius, UnpackColor(color));
+}
+
+void DebugDraw_AddTransform(const char* name, uint32 nameLength, float x, float y, float z, float qx, float qy, float qz, float qw, float scale) {
+	g_debugDrawManager->addTransform({name, nameLength}, {x, y, z}, Quat(qw, qx, qy, qz), Vec3(scale));
+}
+
+
+
+void FFI_DebugDraw::Register(lua_State* L) {
+	if ( luaL_loadbuffer(L, FastPathSource, strlen(FastPathSource), "=DebugDraw_FFI") != 0 ) {
+		SM_ERROR("Failed to load FFI fast path: {}", lua_tostring(L, -1));
+		lua_pop(L, 1);
+		return;
+	}
+
+	lua_pushvalue(L, -2);
+	lua_pushlightuserdata(L, (void*)&DebugDraw_DrawLine);
+	lua_pushlightuserdata(L, (void*)&DebugDraw_AddArrow);
+	lua_pushlightuserdata(L, (void*)&DebugDraw_AddSphere);
+	lua_pushlightuserdata(L, (void*)&DebugDraw_AddTransform);
+	if ( lua_pcall(L, 5, 1, 0) != 0 ) {
+		SM_ERROR("Failed to register FFI fast path: {}", lua_tostring(L, -1));
+		lua_pop(L, 1);
+		return;
+	}
+
+	if ( !lua_toboolean(L, -1) )
+		SM_INFO("FFI library not available, sm.debugDraw.fast is disabled");
+	lua_pop(L, 1);
+}
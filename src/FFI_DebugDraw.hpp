@@ -0,0 +1,28 @@
+#pragma once
+
+#include "lua.hpp"
+
+#include "Types.hpp"
+
+// Plain C functions used by the LuaJIT FFI fast path, so traced Lua code can call them without leaving compiled code.
+// Colors are packed as 0xRRGGBB.
+extern "C" {
+	__declspec(dllexport) void DebugDraw_DrawLine(float x1, float y1, float z1, float x2, float y2, float z2, uint32 color);
+	__declspec(dllexport) void DebugDraw_AddArrow(
+		const char* name, uint32 nameLength,
+		float x1, float y1, float z1, float x2, float y2, float z2, uint32 color
+	);
+	__declspec(dllexport) void DebugDraw_AddSphere(
+		const char* name, uint32 nameLength,
+		float x, float y, float z, float radius, uint32 color
+	);
+	__declspec(dllexport) void DebugDraw_AddTransform(
+		const char* name, uint32 nameLength,
+		float x, float y, float z, float qx, float qy, float qz, float qw, float scale
+	);
+}
+
+namespace FFI_DebugDraw {
+	// Adds the sm.debugDraw.fast table to the debugDraw table at the top of the stack, if the FFI library is available
+	void Register(lua_State* L);
+}
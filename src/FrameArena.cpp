@@ -0,0 +1,41 @@
+#include "FrameArena.hpp"
+
+void* FrameArena::allocate(uint64 size, uint64 alignment) {
+	while ( m_chunk < m_vecChunks.size() ) {
+		Chunk& chunk = m_vecChunks[m_chunk];
+		uint64 base = reinterpret_cast<uint64>(chunk.pData.get());
+		uint64 aligned = (base + m_offset + alignment - 1) & ~(alignment - 1);
+		uint64 end = aligned - base + size;
+		if ( end <= chunk.size ) {
+			m_used += end - m_offset;
+			m_offset = end;
+			return reinterpret_cast<void*>(aligned);
+		}
+		// Whatever is left in the chunk stays unused this frame
+		m_used += chunk.size - m_offset;
+		m_offset = 0;
+		++m_chunk;
+	}
+
+	// Out of chunks, grow geometrically so a busy frame only needs a few of them
+	uint64 chunkSize = m_vecChunks.empty() ? MinChunkSize : m_vecChunks.back().size * 2;
+	if ( chunkSize < size + alignment )
+		chunkSize = size + alignment;
+	m_vecChunks.push_back({std::make_unique_for_overwrite<uint8[]>(chunkSize), chunkSize});
+	m_capacity += chunkSize;
+	return allocate(size, alignment);
+}
+
+void FrameArena::reset() {
+	if ( m_used > m_peak )
+		m_peak = m_used;
+
+	if ( m_vecChunks.size() > 1 ) {
+		// Replace the chunks with one large enough for the whole frame
+		m_vecChunks.clear();
+		m_vecChunks.push_back({std::make_unique_for_overwrite<uint8[]>(m_capacity), m_capacity});
+	}
+	m_chunk = 0;
+	m_offset = 0;
+	m_used = 0;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <type_traits>
+
+#include "Types.hpp"
+
+// Bump allocator for data that only lives until the end of the current frame.
+// Allocating moves an offset forward, reset() frees everything at once.
+// Memory used over several chunks is merged into a single chunk on reset, so steady frames don't allocate at all.
+class FrameArena {
+	public:
+		static constexpr uint64 MinChunkSize = 64 * 1024;
+
+		// Nothing allocated from the arena is destructed, so only trivial types are allowed
+		template <typename T>
+		T* allocate(uint64 count) {
+			static_assert(std::is_trivially_destructible_v<T>);
+			return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+		}
+		void* allocate(uint64 size, uint64 alignment);
+
+		// Invalidates all allocations
+		void reset();
+
+		// Bytes allocated since the last reset, including alignment padding
+		inline uint64 getUsed() const {return m_used;};
+		// Highest usage of any frame so far
+		inline uint64 getPeak() const {return m_peak > m_used ? m_peak : m_used;};
+		inline uint64 getCapacity() const {return m_capacity;};
+
+	private:
+		struct Chunk {
+			std::unique_ptr<uint8[]> pData;
+			uint64 size;
+		};
+
+		std::vector<Chunk> m_vecChunks;
+		uint32 m_chunk = 0;
+		uint64 m_offset = 0;
+		uint64 m_used = 0;
+		uint64 m_peak = 0;
+		uint64 m_capacity = 0;
+};
+
+// Fixed capacity array allocated from a FrameArena, meant for per-frame lists of known maximum size
+template <typename T>
+class FrameArray {
+	public:
+		FrameArray() {};
+		FrameArray(FrameArena& arena, uint32 capacity) : m_pData(arena.allocate<T>(capacity)), m_capacity(capacity) {};
+
+		inline uint32 size() const {return m_size;};
+		inline bool empty() const {return m_size == 0;};
+		inline uint32 capacity() const {return m_capacity;};
+
+		inline T* begin() {return m_pData;};
+		inline T* end() {return m_pData + m_size;};
+		inline const T* begin() const {return m_pData;};
+		inline const T* end() const {return m_pData + m_size;};
+		inline T* data() {return m_pData;};
+		inline T& operator[](uint32 index) {return m_pData[index];};
+		inline const T& operator[](uint32 index) const {return m_pData[index];};
+
+		// The capacity is never exceeded, callers size the array for the worst case
+		inline void push_back(const T& value) {m_pData[m_size++] = value;};
+
+	private:
+		T* m_pData = nullptr;
+		uint32 m_size = 0;
+		uint32 m_capacity = 0;
+};
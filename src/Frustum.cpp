@@ -0,0 +1,46 @@
+#include "glm/gtc/matrix_access.hpp"
+
+#include "Frustum.hpp"
+
+Frustum::Frustum(const Mat4& viewProjection) {
+	Vec4 row0 = glm::row(viewProjection, 0);
+	Vec4 row1 = glm::row(viewProjection, 1);
+	Vec4 row2 = glm::row(viewProjection, 2);
+	Vec4 row3 = glm::row(viewProjection, 3);
+
+	m_arrPlanes[0] = row3 + row0;	// Left
+	m_arrPlanes[1] = row3 - row0;	// Right
+	m_arrPlanes[2] = row3 + row1;	// Bottom
+	m_arrPlanes[3] = row3 - row1;	// Top
+	m_arrPlanes[4] = row3 + row2;	// Near
+	m_arrPlanes[5] = row3 - row2;	// Far
+
+	for ( Vec4& plane : m_arrPlanes )
+		plane /= glm::length(Vec3(plane));
+
+	// Corners of the clip space cube, back in world space
+	Mat4 inverse = glm::inverse(viewProjection);
+	for ( uint32 i = 0; i < 8; ++i ) {
+		Vec4 corner = inverse * Vec4(i & 1 ? 1.0f : -1.0f, i & 2 ? 1.0f : -1.0f, i & 4 ? 1.0f : -1.0f, 1.0f);
+		Vec3 point = Vec3(corner) / corner.w;
+		if ( i == 0 ) {
+			m_boundsMin = point;
+			m_boundsMax = point;
+			continue;
+		}
+		for ( int32 axis = 0; axis < 3; ++axis ) {
+			if ( point[axis] < m_boundsMin[axis] )
+				m_boundsMin[axis] = point[axis];
+			if ( point[axis] > m_boundsMax[axis] )
+				m_boundsMax[axis] = point[axis];
+		}
+	}
+}
+
+bool Frustum::intersects(const BoundingSphere& sphere) const {
+	for ( const Vec4& plane : m_arrPlanes ) {
+		if ( glm::dot(Vec3(plane), sphere.center) + plane.w < -sphere.radius )
+			return false;
+	}
+	return true;
+}
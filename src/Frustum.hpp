@@ -0,0 +1,27 @@
+#pragma once
+
+#include "Types.hpp"
+
+struct BoundingSphere {
+	Vec3 center;
+	float radius;
+};
+
+class Frustum {
+	public:
+		Frustum() {};
+		// Extracts the clip planes from an OpenGL style (-1 to 1 depth) view-projection matrix
+		Frustum(const Mat4& viewProjection);
+
+		bool intersects(const BoundingSphere& sphere) const;
+
+		// Axis aligned box around the frustum's corners
+		inline const Vec3& getMin() const {return m_boundsMin;};
+		inline const Vec3& getMax() const {return m_boundsMax;};
+
+	private:
+		// xyz is the inwards facing normal, w the distance
+		Vec4 m_arrPlanes[6];
+		Vec3 m_boundsMin = Vec3(0.0f);
+		Vec3 m_boundsMax = Vec3(0.0f);
+};
@@ -1,5 +1,6 @@
 
 #include <set>
+#include <cmath>
 
 #include "IcoSphere.hpp"
 
@@ -8,10 +9,10 @@ static Vec3 Vec3Slerp(Vec3 a, Vec3 b, float t) {
 	b = glm::normalize(b);
 
 	float dot = glm::clamp(glm::dot(a, b), -1.0f, 1.0f);
-	float theta = acos(dot) * t;
+	float theta = std::acos(dot) * t;
 
 	Vec3 relative = glm::normalize(b - a * dot);
-	return a * cos(theta) + relative * sin(theta);
+	return a * std::cos(theta) + relative * std::sin(theta);
 }
 
 struct IndexPair {
@@ -125,12 +126,3 @@ IcoSphere::IcoSphere(uint8 depth) {
 
 	m_vecLines.shrink_to_fit();
 }
-
-IcoSphere::IcoSphere(const IcoSphere& base, const Vec3& scale) {
-	m_depth = base.getDepth();
-	m_vecLines = base.getLines();
-	for ( Line& l : m_vecLines ) {
-		l.begin *= scale;
-		l.end *= scale;
-	}
-}
@@ -13,7 +13,6 @@ class IcoSphere {
 
 		IcoSphere() {};
 		IcoSphere(uint8 depth);
-		IcoSphere(const IcoSphere& base, const Vec3& scale);
 
 		inline uint8 getDepth() const {return m_depth;};
 		inline const std::vector<Line>& getLines() const {return m_vecLines;};
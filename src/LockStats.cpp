@@ -0,0 +1,50 @@
+#include "LockStats.hpp"
+
+#ifdef DEBUGDRAW_LOCK_STATS
+
+static std::mutex s_sitesMutex;
+static std::vector<LockSite*> s_vecSites;
+
+static uint32 GetBucket(uint64 ns) {
+	uint64 us = ns / 1000;
+	uint32 bucket = 0;
+	while ( bucket < LockSite::BucketCount - 1 && us >= (uint64(1) << bucket) )
+		++bucket;
+	return bucket;
+}
+
+LockSite::LockSite(const char* name) : name(name) {
+	std::scoped_lock lock(s_sitesMutex);
+	s_vecSites.push_back(this);
+}
+
+void LockSite::record(uint64 wait, uint64 hold) {
+	acquisitions.fetch_add(1, std::memory_order_relaxed);
+	waitNs.fetch_add(wait, std::memory_order_relaxed);
+	holdNs.fetch_add(hold, std::memory_order_relaxed);
+	waitHistogram[GetBucket(wait)].fetch_add(1, std::memory_order_relaxed);
+	holdHistogram[GetBucket(hold)].fetch_add(1, std::memory_order_relaxed);
+
+	uint64 maxWait = maxWaitNs.load(std::memory_order_relaxed);
+	while ( wait > maxWait && !maxWaitNs.compare_exchange_weak(maxWait, wait, std::memory_order_relaxed) );
+}
+
+LockSite::Snapshot LockSite::snapshot() const {
+	Snapshot snap = {name, acquisitions, waitNs, holdNs, maxWaitNs};
+	for ( uint32 i = 0; i < BucketCount; ++i ) {
+		snap.waitHistogram[i] = waitHistogram[i];
+		snap.holdHistogram[i] = holdHistogram[i];
+	}
+	return snap;
+}
+
+std::vector<LockSite::Snapshot> LockSite::GetSnapshots() {
+	std::scoped_lock lock(s_sitesMutex);
+	std::vector<Snapshot> vecSnapshots;
+	vecSnapshots.reserve(s_vecSites.size());
+	for ( const LockSite* pSite : s_vecSites )
+		vecSnapshots.push_back(pSite->snapshot());
+	return vecSnapshots;
+}
+
+#endif
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <mutex>
+
+// Define DEBUGDRAW_LOCK_STATS to record how long every DEBUGDRAW_LOCK_GUARD waits for and holds its lock, and how long every
+// DEBUGDRAW_WAIT_GUARD waits without a lock. Without it the lock guard is a plain std::scoped_lock and the wait guard does nothing.
+// Sites: the drawer lock in render(), the producer queue registration and list updates, and advance()'s wait for producers.
+#ifdef DEBUGDRAW_LOCK_STATS
+
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+#include "Types.hpp"
+
+// Times of one place in the code that takes a lock.
+// Histogram bucket i counts times below 2^i microseconds, the last bucket everything longer.
+struct LockSite {
+	static constexpr uint32 BucketCount = 16;
+
+	struct Snapshot {
+		const char* name;
+		uint64 acquisitions;
+		uint64 waitNs;
+		uint64 holdNs;
+		uint64 maxWaitNs;
+		uint64 waitHistogram[BucketCount];
+		uint64 holdHistogram[BucketCount];
+	};
+
+	// Sites are registered on construction and live until the process exits
+	LockSite(const char* name);
+
+	void record(uint64 waitNs, uint64 holdNs);
+	Snapshot snapshot() const;
+
+	static std::vector<Snapshot> GetSnapshots();
+
+	const char* name;
+	std::atomic<uint64> acquisitions = 0;
+	std::atomic<uint64> waitNs = 0;
+	std::atomic<uint64> holdNs = 0;
+	std::atomic<uint64> maxWaitNs = 0;
+	std::atomic<uint64> waitHistogram[BucketCount] = {};
+	std::atomic<uint64> holdHistogram[BucketCount] = {};
+};
+
+// Holds the lock exclusively for its lifetime and records the wait and hold time in the site
+template <typename Lock>
+class TimedLockGuard {
+	public:
+		TimedLockGuard(Lock& lock, LockSite& site) : m_lock(lock), m_site(site) {
+			auto begin = std::chrono::steady_clock::now();
+			m_lock.lock();
+			m_acquired = std::chrono::steady_clock::now();
+			m_waitNs = uint64(std::chrono::duration_cast<std::chrono::nanoseconds>(m_acquired - begin).count());
+		}
+		~TimedLockGuard() {
+			auto released = std::chrono::steady_clock::now();
+			m_lock.unlock();
+			m_site.record(m_waitNs, uint64(std::chrono::duration_cast<std::chrono::nanoseconds>(released - m_acquired).count()));
+		}
+
+		TimedLockGuard(const TimedLockGuard&) = delete;
+		TimedLockGuard& operator=(const TimedLockGuard&) = delete;
+
+	private:
+		Lock& m_lock;
+		LockSite& m_site;
+		std::chrono::steady_clock::time_point m_acquired;
+		uint64 m_waitNs;
+};
+
+// Records the time until it goes out of scope as a wait, with a hold time of 0
+class TimedWaitGuard {
+	public:
+		TimedWaitGuard(LockSite& site) : m_site(site), m_begin(std::chrono::steady_clock::now()) {};
+		~TimedWaitGuard() {
+			auto end = std::chrono::steady_clock::now();
+			m_site.record(uint64(std::chrono::duration_cast<std::chrono::nanoseconds>(end - m_begin).count()), 0);
+		}
+
+		TimedWaitGuard(const TimedWaitGuard&) = delete;
+		TimedWaitGuard& operator=(const TimedWaitGuard&) = delete;
+
+	private:
+		LockSite& m_site;
+		std::chrono::steady_clock::time_point m_begin;
+};
+
+#define DEBUGDRAW_LOCK_GUARD(guard, lock, siteName) \
+	static LockSite guard##Site(siteName); \
+	TimedLockGuard guard(lock, guard##Site)
+
+#define DEBUGDRAW_WAIT_GUARD(guard, siteName) \
+	static LockSite guard##Site(siteName); \
+	TimedWaitGuard guard(guard##Site)
+
+#else
+
+#define DEBUGDRAW_LOCK_GUARD(guard, lock, siteName) std::scoped_lock guard(lock)
+#define DEBUGDRAW_WAIT_GUARD(guard, siteName)
+
+#endif
@@ -1,7 +1,8 @@
 
 #include "Lua_DebugDraw.hpp"
+#include "FFI_DebugDraw.hpp"
 #include "DebugDrawManager.hpp"
-#include "SM/DebugDrawer.hpp"
+#include "LockStats.hpp"
 #include "SM/Console.hpp"
 
 static constexpr Vec3 UP = {0.0f, 0.0f, 1.0f};
@@ -41,6 +42,61 @@ static u8Vec3 OptColor(lua_State* L, int index, u8Vec3 def) {
 	return u8Vec3(*(Vec3*)luaL_checkudata(L, index, "Color") * 255.0f);
 }
 
+static DebugDrawPriority CheckPriority(lua_State* L, int index) {
+	lua_Integer priority = luaL_checkinteger(L, index);
+	if ( priority < lua_Integer(DebugDrawPriority::Low) || priority > lua_Integer(DebugDrawPriority::High) )
+		luaL_error(L, "invalid priority %d", int(priority));
+	return DebugDrawPriority(priority);
+}
+
+static void PushIntegerField(lua_State* L, const char* key, lua_Integer value) {
+	lua_pushstring(L, key);
+	lua_pushinteger(L, value);
+	lua_rawset(L, -3);
+}
+
+// Like luaL_checkudata, but returns nullptr instead of raising an error
+static void* TestUdata(lua_State* L, int index, const char* tname) {
+	void* p = lua_touserdata(L, index);
+	if ( p == nullptr || !lua_getmetatable(L, index) )
+		return nullptr;
+	lua_getfield(L, LUA_REGISTRYINDEX, tname);
+	bool matches = lua_rawequal(L, -1, -2);
+	lua_pop(L, 2);
+	return (matches ? p : nullptr);
+}
+
+static Vec3 CheckTableVec3(lua_State* L, int tableIndex, uint32 elemIndex) {
+	lua_rawgeti(L, tableIndex, int(elemIndex));
+	Vec3* pVec = (Vec3*)TestUdata(L, -1, "Vec3");
+	if ( pVec == nullptr )
+		luaL_error(L, "expected Vec3 at index %d, got %s", int(elemIndex), luaL_typename(L, -1));
+	Vec3 vec = *pVec;
+	lua_pop(L, 1);
+	return vec;
+}
+
+static u8Vec3 CheckTableColor(lua_State* L, int tableIndex, uint32 elemIndex) {
+	lua_rawgeti(L, tableIndex, int(elemIndex));
+	Vec3* pColor = (Vec3*)TestUdata(L, -1, "Color");
+	if ( pColor == nullptr )
+		luaL_error(L, "expected Color at index %d, got %s", int(elemIndex), luaL_typename(L, -1));
+	u8Vec3 color = u8Vec3(*pColor * 255.0f);
+	lua_pop(L, 1);
+	return color;
+}
+
+// Returns true for "strip", false for "list"
+static bool CheckLineMode(lua_State* L, int index) {
+	std::string_view mode = CheckString(L, index, true);
+	if ( mode.empty() || mode == "list" )
+		return false;
+	if ( mode == "strip" )
+		return true;
+	luaL_error(L, "expected line mode \"list\" or \"strip\", got \"%s\"", mode.data());
+	return false;
+}
+
 static Quat* CheckQuat(lua_State* L, int index) {
 	return (Quat*)luaL_checkudata(L, index, "Quat");
 }
@@ -52,9 +108,220 @@ static bool CheckBoolean(lua_State* L, int index) {
 	return lua_toboolean(L, index);
 }
 
+static constexpr const char* GroupMetatable = "DebugDraw.Group";
+
+struct LuaGroup {
+	uint32 id;
+};
+
+// Checks the group passed as self and removes it, so the remaining arguments line up with the ungrouped functions
+static uint32 CheckSelfGroup(lua_State* L) {
+	uint32 id = ((LuaGroup*)luaL_checkudata(L, 1, GroupMetatable))->id;
+	lua_remove(L, 1);
+	return id;
+}
+
+static int AddArrow(lua_State* L, uint32 group) {
+	CheckArgCount(L, 2, 5);
+	std::string_view name = CheckString(L, 1);
+	Vec3* pStartPos = CheckVec3(L, 2);
+	Vec3* pEndPos = CheckVec3(L, 3, true);
+	g_debugDrawManager->addArrow(
+		name, *pStartPos,
+		(pEndPos != nullptr ? *pEndPos : *pStartPos + UP),
+		OptColor(L, 4, WHITE), group,
+		float(luaL_optnumber(L, 5, 0.0))
+	);
+	return 0;
+}
+
+static int AddSphere(lua_State* L, uint32 group) {
+	CheckArgCount(L, 2, 5);
+	std::string_view name = CheckString(L, 1);
+	Vec3* pPosition = CheckVec3(L, 2);
+	float radius = float(luaL_optnumber(L, 3, 0.125));
+	g_debugDrawManager->addSphere(
+		name, *pPosition, radius,
+		OptColor(L, 4, WHITE), group,
+		float(luaL_optnumber(L, 5, 0.0))
+	);
+	return 0;
+}
+
+static int AddTransform(lua_State* L, uint32 group) {
+	CheckArgCount(L, 3, 5);
+	std::string_view name = CheckString(L, 1);
+	Vec3* pOrigin = CheckVec3(L, 2);
+	Quat* pRotation = CheckQuat(L, 3);
+	float scale = float(luaL_optnumber(L, 4, 1.0));
+	g_debugDrawManager->addTransform(name, *pOrigin, *pRotation, Vec3(scale), group, float(luaL_optnumber(L, 5, 0.0)));
+	return 0;
+}
+
+static int Clear(lua_State* L, uint32 group) {
+	CheckArgCount(L, 0, 1);
+	g_debugDrawManager->clear(CheckString(L, 1, true), group);
+	return 0;
+}
+
+static int RemoveArrow(lua_State* L, uint32 group) {
+	CheckArgCount(L, 1, 1);
+	g_debugDrawManager->removeArrow(CheckString(L, 1), group);
+	return 0;
+}
+
+static int RemoveSphere(lua_State* L, uint32 group) {
+	CheckArgCount(L, 1, 1);
+	g_debugDrawManager->removeSphere(CheckString(L, 1), group);
+	return 0;
+}
+
+static int RemoveTransform(lua_State* L, uint32 group) {
+	CheckArgCount(L, 1, 1);
+	g_debugDrawManager->removeTransform(CheckString(L, 1), group);
+	return 0;
+}
+
+static int Group_addArrow(lua_State* L) {return AddArrow(L, CheckSelfGroup(L));}
+static int Group_addSphere(lua_State* L) {return AddSphere(L, CheckSelfGroup(L));}
+static int Group_addTransform(lua_State* L) {return AddTransform(L, CheckSelfGroup(L));}
+static int Group_clear(lua_State* L) {return Clear(L, CheckSelfGroup(L));}
+static int Group_removeArrow(lua_State* L) {return RemoveArrow(L, CheckSelfGroup(L));}
+static int Group_removeSphere(lua_State* L) {return RemoveSphere(L, CheckSelfGroup(L));}
+static int Group_removeTransform(lua_State* L) {return RemoveTransform(L, CheckSelfGroup(L));}
+
+static int Group_setVisible(lua_State* L) {
+	uint32 group = CheckSelfGroup(L);
+	CheckArgCount(L, 1, 1);
+	g_debugDrawManager->setGroupVisible(group, CheckBoolean(L, 1));
+	return 0;
+}
+
+static void RegisterGroupMetatable(lua_State* L) {
+	static constexpr luaL_Reg methods[] = {
+		{"addArrow", Group_addArrow},
+		{"addSphere", Group_addSphere},
+		{"addTransform", Group_addTransform},
+		{"clear", Group_clear},
+		{"removeArrow", Group_removeArrow},
+		{"removeSphere", Group_removeSphere},
+		{"removeTransform", Group_removeTransform},
+		{"setVisible", Group_setVisible}
+	};
+
+	luaL_newmetatable(L, GroupMetatable);
+	lua_pushstring(L, "__index");
+	lua_createtable(L, 0, int(std::size(methods)));
+	for ( const luaL_Reg& method : methods ) {
+		lua_pushstring(L, method.name);
+		lua_pushcfunction(L, method.func);
+		lua_rawset(L, -3);
+	}
+	lua_rawset(L, -3);
+	lua_pop(L, 1);
+}
+
+
+static constexpr const char* ArrowHandleMetatable = "DebugDraw.ArrowHandle";
+static constexpr const char* SphereHandleMetatable = "DebugDraw.SphereHandle";
+static constexpr const char* TransformHandleMetatable = "DebugDraw.TransformHandle";
+
+struct LuaHandle {
+	uint32 id;
+};
+
+// Pushed after the shape arguments were read, missing optional arguments would be read as the handle otherwise
+static void PushHandle(lua_State* L, const char* metatable, uint32 handle) {
+	LuaHandle* pHandle = (LuaHandle*)lua_newuserdata(L, sizeof(LuaHandle));
+	pHandle->id = handle;
+	luaL_getmetatable(L, metatable);
+	lua_setmetatable(L, -2);
+}
+
+// The shape arguments start at index base
+static void SetArrow(lua_State* L, int base, uint32 handle) {
+	Vec3* pStartPos = CheckVec3(L, base);
+	Vec3* pEndPos = CheckVec3(L, base + 1, true);
+	g_debugDrawManager->setArrow(
+		handle, *pStartPos,
+		(pEndPos != nullptr ? *pEndPos : *pStartPos + UP),
+		OptColor(L, base + 2, WHITE)
+	);
+}
+
+static void SetSphere(lua_State* L, int base, uint32 handle) {
+	Vec3* pPosition = CheckVec3(L, base);
+	float radius = float(luaL_optnumber(L, base + 1, 0.125));
+	g_debugDrawManager->setSphere(handle, *pPosition, radius, OptColor(L, base + 2, WHITE));
+}
+
+static void SetTransform(lua_State* L, int base, uint32 handle) {
+	Vec3* pOrigin = CheckVec3(L, base);
+	Quat* pRotation = CheckQuat(L, base + 1);
+	float scale = float(luaL_optnumber(L, base + 2, 1.0));
+	g_debugDrawManager->setTransform(handle, *pOrigin, *pRotation, Vec3(scale));
+}
+
+static int ArrowHandle_set(lua_State* L) {
+	CheckArgCount(L, 2, 4);
+	SetArrow(L, 2, ((LuaHandle*)luaL_checkudata(L, 1, ArrowHandleMetatable))->id);
+	return 0;
+}
+
+static int SphereHandle_set(lua_State* L) {
+	CheckArgCount(L, 2, 4);
+	SetSphere(L, 2, ((LuaHandle*)luaL_checkudata(L, 1, SphereHandleMetatable))->id);
+	return 0;
+}
+
+static int TransformHandle_set(lua_State* L) {
+	CheckArgCount(L, 3, 4);
+	SetTransform(L, 2, ((LuaHandle*)luaL_checkudata(L, 1, TransformHandleMetatable))->id);
+	return 0;
+}
+
+// Shared by all handle kinds, also used as __gc
+static int Handle_remove(lua_State* L) {
+	LuaHandle* pHandle = (LuaHandle*)TestUdata(L, 1, ArrowHandleMetatable);
+	if ( pHandle == nullptr )
+		pHandle = (LuaHandle*)TestUdata(L, 1, SphereHandleMetatable);
+	if ( pHandle == nullptr )
+		pHandle = (LuaHandle*)TestUdata(L, 1, TransformHandleMetatable);
+	if ( pHandle == nullptr )
+		luaL_error(L, "expected debug draw handle, got %s", luaL_typename(L, 1));
+	if ( g_debugDrawManager != nullptr )
+		g_debugDrawManager->removeHandle(pHandle->id);
+	return 0;
+}
+
+static void RegisterHandleMetatable(lua_State* L, const char* metatable, lua_CFunction set) {
+	luaL_newmetatable(L, metatable);
+
+	lua_pushstring(L, "__index");
+	lua_createtable(L, 0, 2);
+	lua_pushstring(L, "set");
+	lua_pushcfunction(L, set);
+	lua_rawset(L, -3);
+	lua_pushstring(L, "remove");
+	lua_pushcfunction(L, Handle_remove);
+	lua_rawset(L, -3);
+	lua_rawset(L, -3);
+
+	lua_pushstring(L, "__gc");
+	lua_pushcfunction(L, Handle_remove);
+	lua_rawset(L, -3);
+
+	lua_pop(L, 1);
+}
+
 
 
 void Lua_DebugDraw::Register(lua_State* L) {
+	RegisterGroupMetatable(L);
+	RegisterHandleMetatable(L, ArrowHandleMetatable, ArrowHandle_set);
+	RegisterHandleMetatable(L, SphereHandleMetatable, SphereHandle_set);
+	RegisterHandleMetatable(L, TransformHandleMetatable, TransformHandle_set);
+
 	lua_getglobal(L, "sm");
 	SM_ASSERT(lua_istable(L, -1));
 
@@ -93,10 +360,65 @@ void Lua_DebugDraw::Register(lua_State* L) {
 	lua_pushcfunction(L, drawLine);
 	lua_rawset(L, -3);
 
+	lua_pushstring(L, "drawLines");
+	lua_pushcfunction(L, drawLines);
+	lua_rawset(L, -3);
+
+	lua_pushstring(L, "setPriority");
+	lua_pushcfunction(L, setPriority);
+	lua_rawset(L, -3);
+
+	lua_pushstring(L, "setVertexBudget");
+	lua_pushcfunction(L, setVertexBudget);
+	lua_rawset(L, -3);
+
+	lua_pushstring(L, "setWorkerThreads");
+	lua_pushcfunction(L, setWorkerThreads);
+	lua_rawset(L, -3);
+
+	lua_pushstring(L, "getStats");
+	lua_pushcfunction(L, getStats);
+	lua_rawset(L, -3);
+
+	lua_pushstring(L, "setCamera");
+	lua_pushcfunction(L, setCamera);
+	lua_rawset(L, -3);
+
+	lua_pushstring(L, "group");
+	lua_pushcfunction(L, group);
+	lua_rawset(L, -3);
+
+	lua_pushstring(L, "createArrow");
+	lua_pushcfunction(L, createArrow);
+	lua_rawset(L, -3);
+
+	lua_pushstring(L, "createSphere");
+	lua_pushcfunction(L, createSphere);
+	lua_rawset(L, -3);
+
+	lua_pushstring(L, "createTransform");
+	lua_pushcfunction(L, createTransform);
+	lua_rawset(L, -3);
+
+#ifdef DEBUGDRAW_LOCK_STATS
+	lua_pushstring(L, "getLockStats");
+	lua_pushcfunction(L, getLockStats);
+	lua_rawset(L, -3);
+#endif
+
+	lua_pushstring(L, "priorities");
+	lua_newtable(L);
+	PushIntegerField(L, "low", int(DebugDrawPriority::Low));
+	PushIntegerField(L, "normal", int(DebugDrawPriority::Normal));
+	PushIntegerField(L, "high", int(DebugDrawPriority::High));
+	lua_rawset(L, -3);
+
 	lua_pushstring(L, "enabled");
 	lua_pushboolean(L, g_debugDrawManager->isEnabled());
 	lua_rawset(L, -3);
 
+	FFI_DebugDraw::Register(L);
+
 	lua_pushvalue(L, -2);
 	lua_pushvalue(L, -2);
 	lua_rawset(L, -5);
@@ -107,71 +429,200 @@ void Lua_DebugDraw::Register(lua_State* L) {
 }
 
 int Lua_DebugDraw::addArrow(lua_State* L) {
-	CheckArgCount(L, 2, 4);
-	std::string_view name = CheckString(L, 1);
-	Vec3* pStartPos = CheckVec3(L, 2);
-	Vec3* pEndPos = CheckVec3(L, 3, true);
-	g_debugDrawManager->addArrow(
-		name, *pStartPos,
-		(pEndPos != nullptr ? *pEndPos : *pStartPos + UP),
-		OptColor(L, 4, WHITE)
-	);
-	return 0;
+	return AddArrow(L, DebugDrawManager::DefaultGroup);
 }
 
 int Lua_DebugDraw::addSphere(lua_State* L) {
-	CheckArgCount(L, 2, 4);
-	std::string_view name = CheckString(L, 1);
-	Vec3* pPosition = CheckVec3(L, 2);
-	float radius = float(luaL_optnumber(L, 3, 0.125));
-	g_debugDrawManager->addSphere(
-		name, *pPosition, radius,
-		OptColor(L, 4, WHITE)
-	);
-	return 0;
+	return AddSphere(L, DebugDrawManager::DefaultGroup);
 }
 
 int Lua_DebugDraw::addTransform(lua_State* L) {
-	CheckArgCount(L, 3, 4);
-	std::string_view name = CheckString(L, 1);
-	Vec3* pOrigin = CheckVec3(L, 2);
-	Quat* pRotation = CheckQuat(L, 3);
-	float scale = float(luaL_optnumber(L, 4, 1.0));
-	g_debugDrawManager->addTransform(name, *pOrigin, *pRotation, Vec3(scale));
-	return 0;
+	return AddTransform(L, DebugDrawManager::DefaultGroup);
 }
 
 int Lua_DebugDraw::clear(lua_State* L) {
-	CheckArgCount(L, 0, 1);
-	g_debugDrawManager->clear(CheckString(L, 1, true));
-	return 0;
+	return Clear(L, DebugDrawManager::DefaultGroup);
 }
 
 int Lua_DebugDraw::removeArrow(lua_State* L) {
-	CheckArgCount(L, 1, 1);
-	g_debugDrawManager->removeArrow(CheckString(L, 1));
-	return 0;
+	return RemoveArrow(L, DebugDrawManager::DefaultGroup);
 }
 
 int Lua_DebugDraw::removeSphere(lua_State* L) {
-	CheckArgCount(L, 1, 1);
-	g_debugDrawManager->removeSphere(CheckString(L, 1));
-	return 0;
+	return RemoveSphere(L, DebugDrawManager::DefaultGroup);
 }
 
 int Lua_DebugDraw::removeTransform(lua_State* L) {
-	CheckArgCount(L, 1, 1);
-	g_debugDrawManager->removeTransform(CheckString(L, 1));
-	return 0;
+	return RemoveTransform(L, DebugDrawManager::DefaultGroup);
 }
 
 int Lua_DebugDraw::drawLine(lua_State* L) {
-	CheckArgCount(L, 1, 3);
+	CheckArgCount(L, 1, 4);
 	Vec3* pBegin = CheckVec3(L, 1);
 	Vec3* pEnd = CheckVec3(L, 2, true);
 	u8Vec3 color = OptColor(L, 3, {0xFF, 0xFF, 0xFF});
-	SM::DebugDrawer* pDrawer = SM::DebugDrawer::Get();
-	std::scoped_lock lock(pDrawer->getLock());
-	pDrawer->drawLine(*pBegin, (pEnd != nullptr ? *pEnd : *pBegin + Vec3(0.0f, 0.0f, 1.0f)), color);
+	float lifetime = float(luaL_optnumber(L, 4, 0.0));
+	Vec3 end = (pEnd != nullptr ? *pEnd : *pBegin + UP);
+	if ( lifetime > 0.0f )
+		g_debugDrawManager->addLine(*pBegin, end, color, lifetime);
+	else
+		g_debugDrawManager->drawLine(*pBegin, end, color);
+	return 0;
+}
+
+int Lua_DebugDraw::drawLines(lua_State* L) {
+	CheckArgCount(L, 1, 4);
+	luaL_checktype(L, 1, LUA_TTABLE);
+	bool strip = CheckLineMode(L, 3);
+	lua_Integer frames = luaL_optinteger(L, 4, 1);
+	if ( frames < 1 )
+		luaL_error(L, "frame count must be at least 1");
+
+	uint32 pointCount = uint32(lua_objlen(L, 1));
+	uint32 lineCount = 0;
+	if ( strip )
+		lineCount = (pointCount > 1 ? pointCount - 1 : 0);
+	else {
+		if ( pointCount % 2 != 0 )
+			luaL_error(L, "expected an even number of points, got %d", int(pointCount));
+		lineCount = pointCount / 2;
+	}
+
+	bool perLineColors = (lua_type(L, 2) == LUA_TTABLE);
+	if ( perLineColors && lua_objlen(L, 2) < lineCount )
+		luaL_error(L, "expected %d colors, got %d", int(lineCount), int(lua_objlen(L, 2)));
+	u8Vec4 color = SM::ToLineVertexColor(perLineColors ? WHITE : OptColor(L, 2, WHITE));
+
+	// Validate and convert everything first, so nothing is staged if an argument is invalid
+	static thread_local std::vector<SM::LineVertex> s_vecVertices;
+	s_vecVertices.clear();
+	s_vecVertices.reserve(lineCount * 2);
+	for ( uint32 i = 0; i < lineCount; ++i ) {
+		if ( perLineColors )
+			color = SM::ToLineVertexColor(CheckTableColor(L, 2, i + 1));
+		uint32 beginIndex = (strip ? i + 1 : i * 2 + 1);
+		s_vecVertices.emplace_back(CheckTableVec3(L, 1, beginIndex), color);
+		s_vecVertices.emplace_back(CheckTableVec3(L, 1, beginIndex + 1), color);
+	}
+
+	g_debugDrawManager->drawLines(s_vecVertices.data(), uint32(s_vecVertices.size()), uint32(std::min<lua_Integer>(frames, DebugDrawManager::MaxLineFrames)));
 	return 0;
 }
+
+int Lua_DebugDraw::setPriority(lua_State* L) {
+	CheckArgCount(L, 2, 2);
+	std::string_view prefix = CheckString(L, 1);
+	g_debugDrawManager->setPriority(prefix, CheckPriority(L, 2));
+	return 0;
+}
+
+int Lua_DebugDraw::setVertexBudget(lua_State* L) {
+	CheckArgCount(L, 1, 1);
+	lua_Integer budget = luaL_checkinteger(L, 1);
+	if ( budget < 0 )
+		luaL_error(L, "vertex budget must not be negative");
+	g_debugDrawManager->setVertexBudget(uint32(std::min<lua_Integer>(budget, UINT32_MAX)));
+	return 0;
+}
+
+int Lua_DebugDraw::setWorkerThreads(lua_State* L) {
+	CheckArgCount(L, 1, 1);
+	lua_Integer count = luaL_checkinteger(L, 1);
+	if ( count < 0 )
+		luaL_error(L, "worker thread count must not be negative");
+	g_debugDrawManager->setWorkerThreads(uint32(std::min<lua_Integer>(count, UINT32_MAX)));
+	return 0;
+}
+
+int Lua_DebugDraw::getStats(lua_State* L) {
+	CheckArgCount(L, 0, 0);
+	DebugDrawManager::FrameStats stats = g_debugDrawManager->getFrameStats();
+	lua_createtable(L, 0, 6);
+	PushIntegerField(L, "emittedVertices", stats.emittedVertices);
+	PushIntegerField(L, "droppedShapes", stats.droppedShapes);
+	PushIntegerField(L, "reducedSpheres", stats.reducedSpheres);
+	PushIntegerField(L, "culledShapes", stats.culledShapes);
+	PushIntegerField(L, "arenaUsedBytes", stats.arenaUsedBytes);
+	PushIntegerField(L, "arenaPeakBytes", stats.arenaPeakBytes);
+	return 1;
+}
+
+#ifdef DEBUGDRAW_LOCK_STATS
+static void PushHistogramField(lua_State* L, const char* key, const uint64* pBuckets) {
+	lua_pushstring(L, key);
+	lua_createtable(L, LockSite::BucketCount, 0);
+	for ( uint32 i = 0; i < LockSite::BucketCount; ++i ) {
+		lua_pushinteger(L, lua_Integer(pBuckets[i]));
+		lua_rawseti(L, -2, i + 1);
+	}
+	lua_rawset(L, -3);
+}
+
+int Lua_DebugDraw::getLockStats(lua_State* L) {
+	CheckArgCount(L, 0, 0);
+	std::vector<LockSite::Snapshot> vecSites = LockSite::GetSnapshots();
+	lua_createtable(L, 0, int(vecSites.size()));
+	for ( const LockSite::Snapshot& site : vecSites ) {
+		lua_pushstring(L, site.name);
+		lua_createtable(L, 0, 6);
+		PushIntegerField(L, "acquisitions", lua_Integer(site.acquisitions));
+		PushIntegerField(L, "waitUs", lua_Integer(site.waitNs / 1000));
+		PushIntegerField(L, "holdUs", lua_Integer(site.holdNs / 1000));
+		PushIntegerField(L, "maxWaitUs", lua_Integer(site.maxWaitNs / 1000));
+		PushHistogramField(L, "waitHistogram", site.waitHistogram);
+		PushHistogramField(L, "holdHistogram", site.holdHistogram);
+		lua_rawset(L, -3);
+	}
+	return 1;
+}
+#endif
+
+int Lua_DebugDraw::setCamera(lua_State* L) {
+	CheckArgCount(L, 0, 4);
+	Vec3* pPosition = CheckVec3(L, 1, true);
+	if ( pPosition == nullptr ) {
+		g_debugDrawManager->resetCamera();
+		return 0;
+	}
+	float fov = float(luaL_checknumber(L, 2));
+	Vec3* pDirection = CheckVec3(L, 3, true);
+	float aspect = float(luaL_optnumber(L, 4, 16.0 / 9.0));
+	g_debugDrawManager->setCamera(*pPosition, fov, (pDirection != nullptr ? *pDirection : Vec3(0.0f)), aspect);
+	return 0;
+}
+
+int Lua_DebugDraw::group(lua_State* L) {
+	CheckArgCount(L, 1, 1);
+	std::string_view name = CheckString(L, 1);
+	if ( name.empty() )
+		luaL_error(L, "group name must not be empty");
+	LuaGroup* pGroup = (LuaGroup*)lua_newuserdata(L, sizeof(LuaGroup));
+	pGroup->id = g_debugDrawManager->getGroupId(name);
+	luaL_getmetatable(L, GroupMetatable);
+	lua_setmetatable(L, -2);
+	return 1;
+}
+
+int Lua_DebugDraw::createArrow(lua_State* L) {
+	CheckArgCount(L, 1, 3);
+	uint32 handle = g_debugDrawManager->createHandle();
+	SetArrow(L, 1, handle);
+	PushHandle(L, ArrowHandleMetatable, handle);
+	return 1;
+}
+
+int Lua_DebugDraw::createSphere(lua_State* L) {
+	CheckArgCount(L, 1, 3);
+	uint32 handle = g_debugDrawManager->createHandle();
+	SetSphere(L, 1, handle);
+	PushHandle(L, SphereHandleMetatable, handle);
+	return 1;
+}
+
+int Lua_DebugDraw::createTransform(lua_State* L) {
+	CheckArgCount(L, 2, 3);
+	uint32 handle = g_debugDrawManager->createHandle();
+	SetTransform(L, 1, handle);
+	PushHandle(L, TransformHandleMetatable, handle);
+	return 1;
+}
@@ -15,4 +15,17 @@ namespace Lua_DebugDraw {
 
 	// Extras
 	int drawLine(lua_State* L);
+	int drawLines(lua_State* L);
+	int setPriority(lua_State* L);
+	int setVertexBudget(lua_State* L);
+	int setWorkerThreads(lua_State* L);
+	int getStats(lua_State* L);
+	int setCamera(lua_State* L);
+	int group(lua_State* L);
+	int createArrow(lua_State* L);
+	int createSphere(lua_State* L);
+	int createTransform(lua_State* L);
+#ifdef DEBUGDRAW_LOCK_STATS
+	int getLockStats(lua_State* L);
+#endif
 }
@@ -0,0 +1,77 @@
+#include <cstring>
+
+#include "NamePool.hpp"
+
+uint32 NamePool::find(const std::string_view& name) const {
+	auto it = m_setSorted.find(name);
+	return (it != m_setSorted.end() ? *it : InvalidId);
+}
+
+uint32 NamePool::add(const std::string_view& name, uint64 key) {
+	char* pData = allocateChars(uint32(name.size()));
+	if ( !name.empty() )
+		std::memcpy(pData, name.data(), name.size());
+
+	uint32 id;
+	if ( !m_vecFreeIds.empty() ) {
+		id = m_vecFreeIds.back();
+		m_vecFreeIds.pop_back();
+	} else {
+		id = uint32(m_vecEntries.size());
+		m_vecEntries.emplace_back();
+	}
+	m_vecEntries[id] = {key, pData, uint32(name.size()), 0};
+	m_setSorted.insert(id);
+	return id;
+}
+
+void NamePool::remove(uint32 id) {
+	m_setSorted.erase(id);
+	release(id);
+}
+
+void NamePool::clear() {
+	m_vecEntries.clear();
+	m_vecFreeIds.clear();
+	m_setSorted.clear();
+	m_vecChunks.clear();
+	m_pChunkCursor = nullptr;
+	m_chunkRemaining = 0;
+	m_mapFreeChars.clear();
+}
+
+char* NamePool::allocateChars(uint32 length) {
+	if ( length == 0 )
+		return nullptr;
+
+	auto it = m_mapFreeChars.find(length);
+	if ( it != m_mapFreeChars.end() && !it->second.empty() ) {
+		char* pData = it->second.back();
+		it->second.pop_back();
+		return pData;
+	}
+
+	// Long names get a chunk of their own, keeping the current chunk for the short ones
+	if ( length > ChunkSize / 4 ) {
+		m_vecChunks.push_back(std::make_unique_for_overwrite<char[]>(length));
+		return m_vecChunks.back().get();
+	}
+
+	if ( length > m_chunkRemaining ) {
+		m_vecChunks.push_back(std::make_unique_for_overwrite<char[]>(ChunkSize));
+		m_pChunkCursor = m_vecChunks.back().get();
+		m_chunkRemaining = ChunkSize;
+	}
+	char* pData = m_pChunkCursor;
+	m_pChunkCursor += length;
+	m_chunkRemaining -= length;
+	return pData;
+}
+
+void NamePool::release(uint32 id) {
+	Entry& entry = m_vecEntries[id];
+	if ( entry.length != 0 )
+		m_mapFreeChars[entry.length].push_back(entry.pData);
+	entry = {};
+	m_vecFreeIds.push_back(id);
+}
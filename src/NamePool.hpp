@@ -0,0 +1,87 @@
+#pragma once
+
+#include <string_view>
+#include <vector>
+#include <set>
+#include <memory>
+
+#include "NullHash.hpp"
+#include "Types.hpp"
+
+// Interns the names of a group's shapes, so shapes only hold a 32-bit id.
+// The characters are stored once in large chunks, freed storage is reused by later names of the same length.
+// A set of ids sorted by name lets prefix lookups visit only the matching names.
+class NamePool {
+	public:
+		static constexpr uint32 InvalidId = 0xFFFFFFFF;
+		static constexpr uint32 ChunkSize = 64 * 1024;
+
+		struct Entry {
+			uint64 key;	// The name's hash, unless it collided with another name
+			char* pData;
+			uint32 length;
+			uint8 shapes;	// Bit mask of the shape kinds using the name
+		};
+
+		NamePool() : m_setSorted(Less{this}) {};
+		// The sorted set refers back to the pool
+		NamePool(const NamePool&) = delete;
+		NamePool& operator=(const NamePool&) = delete;
+
+		inline uint32 size() const {return uint32(m_setSorted.size());};
+		inline std::string_view get(uint32 id) const {return {m_vecEntries[id].pData, m_vecEntries[id].length};};
+		inline Entry& operator[](uint32 id) {return m_vecEntries[id];};
+		inline const Entry& operator[](uint32 id) const {return m_vecEntries[id];};
+
+		// Returns InvalidId if the name isn't in the pool
+		uint32 find(const std::string_view& name) const;
+		// The name must not be in the pool yet
+		uint32 add(const std::string_view& name, uint64 key);
+		void remove(uint32 id);
+		void clear();
+
+		// Calls func(id, entry) for every name starting with the prefix, in sorted order.
+		// func must not add or remove names.
+		template <typename Func>
+		void forEachPrefix(const std::string_view& prefix, Func func) {
+			for ( auto it = m_setSorted.lower_bound(prefix); it != m_setSorted.end() && get(*it).starts_with(prefix); ++it )
+				func(*it, m_vecEntries[*it]);
+		}
+
+		// Calls func(entry) for every name starting with the prefix and removes the name afterwards
+		template <typename Func>
+		void removePrefix(const std::string_view& prefix, Func func) {
+			auto it = m_setSorted.lower_bound(prefix);
+			while ( it != m_setSorted.end() && get(*it).starts_with(prefix) ) {
+				uint32 id = *it;
+				func(m_vecEntries[id]);
+				it = m_setSorted.erase(it);
+				release(id);
+			}
+		}
+
+	private:
+		// Compares ids by their names, string views can be looked up directly
+		struct Less {
+			using is_transparent = void;
+			const NamePool* pPool;
+
+			inline bool operator()(uint32 a, uint32 b) const {return pPool->get(a) < pPool->get(b);};
+			inline bool operator()(uint32 a, const std::string_view& b) const {return pPool->get(a) < b;};
+			inline bool operator()(const std::string_view& a, uint32 b) const {return a < pPool->get(b);};
+		};
+
+		char* allocateChars(uint32 length);
+		// Frees the id and storage of a name that is no longer in the sorted set
+		void release(uint32 id);
+
+		std::vector<Entry> m_vecEntries;
+		std::vector<uint32> m_vecFreeIds;
+		std::set<uint32, Less> m_setSorted;
+
+		std::vector<std::unique_ptr<char[]>> m_vecChunks;
+		char* m_pChunkCursor = nullptr;
+		uint32 m_chunkRemaining = 0;
+		// Freed storage by name length
+		NullHashMap<uint32, std::vector<char*>> m_mapFreeChars;
+};
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <thread>
+
+#include "Types.hpp"
+#include "LockStats.hpp"
+
+// Hands buffers written by any number of producer threads to a single consumer thread.
+// Every producer thread gets its own queue with two sets of buffers. Producers write into the set of the current epoch's parity
+// and announce the epoch while doing so. advance() moves to the next epoch and waits until no producer still announces the old
+// one, after which the consumer owns the old set until the next advance.
+// Writing never takes a lock. The mutex is taken once per thread to register its queue, and by advance() only when queues were
+// registered or freed since the last advance.
+// The queue of an exited thread is freed by the advance after the one that took the last buffers it wrote.
+template <typename Buffers>
+class ProducerQueues {
+	private:
+		struct Queue;
+
+	public:
+		// Announces the current epoch while alive, also ending the announcement if writing the buffers throws
+		class Producer {
+			public:
+				Producer(ProducerQueues& queues) : m_queue(queues.getQueue()), m_buffers(queues.beginProducing(m_queue)) {};
+				~Producer() {m_queue.activeEpoch.store(Queue::Idle);};
+
+				Producer(const Producer&) = delete;
+				Producer& operator=(const Producer&) = delete;
+
+				inline Buffers& getBuffers() {return m_buffers;};
+
+			private:
+				Queue& m_queue;
+				Buffers& m_buffers;
+		};
+
+		// Only called by the consumer thread
+		void advance() {
+			// Everything an exited thread wrote was taken by the first advance after it was seen exited
+			uint64 epoch = m_epoch.load();
+			bool bFreed = false;
+			for ( Queue* pQueue : m_vecTakenQueues ) {
+				if ( !pQueue->bExited.load() )
+					continue;
+				if ( pQueue->exitEpoch == Queue::Idle )
+					pQueue->exitEpoch = epoch;
+				else
+					bFreed = true;
+			}
+			if ( bFreed ) {
+				DEBUGDRAW_LOCK_GUARD(lock, m_mutex, "producer queue free");
+				std::erase_if(m_vecQueues, [epoch](const std::shared_ptr<Queue>& pQueue) {return pQueue->exitEpoch < epoch;});
+				m_bQueuesChanged.store(true);
+			}
+
+			m_epoch.fetch_add(1);
+
+			// Queues registered after this only ever see the new epoch
+			if ( m_bQueuesChanged.exchange(false) ) {
+				DEBUGDRAW_LOCK_GUARD(lock, m_mutex, "producer queue list");
+				m_vecTakenQueues.resize(m_vecQueues.size());
+				for ( size_t i = 0; i < m_vecQueues.size(); ++i )
+					m_vecTakenQueues[i] = m_vecQueues[i].get();
+			}
+
+			// Wait for the producers still writing into the old buffers
+			DEBUGDRAW_WAIT_GUARD(wait, "producer grace wait");
+			for ( Queue* pQueue : m_vecTakenQueues ) {
+				while ( pQueue->activeEpoch.load() == epoch )
+					std::this_thread::yield();
+			}
+			m_takenParity = uint32(epoch & 1);
+		}
+
+		// Calls func(buffers) for every set of buffers taken by the last advance, only called by the consumer thread
+		template <typename Func>
+		void forEachTaken(Func func) {
+			for ( Queue* pQueue : m_vecTakenQueues )
+				func(pQueue->buffers[m_takenParity]);
+		}
+
+		// Queues known to the consumer as of the last advance
+		inline uint32 getQueueCount() const {return uint32(m_vecTakenQueues.size());};
+
+	private:
+		struct alignas(64) Queue {
+			static constexpr uint64 Idle = ~uint64(0);
+			std::atomic<uint64> activeEpoch = Idle;
+			std::atomic<bool> bExited = false;
+			// Epoch in which the consumer first saw bExited, only accessed by the consumer
+			uint64 exitEpoch = Idle;
+			Buffers buffers[2];
+		};
+
+		// Shares ownership of the thread's queue, so the thread can still mark it exited after its owner is gone
+		struct Registration {
+			uint64 ownerId = 0;
+			std::shared_ptr<Queue> pQueue;
+
+			~Registration() {
+				if ( pQueue )
+					pQueue->bExited.store(true);
+			}
+		};
+
+		Queue& getQueue() {
+			thread_local Registration t_registration;
+			if ( t_registration.ownerId != m_id ) {
+				if ( t_registration.pQueue )
+					t_registration.pQueue->bExited.store(true);
+				std::shared_ptr<Queue> pQueue = std::make_shared<Queue>();
+				{
+					DEBUGDRAW_LOCK_GUARD(lock, m_mutex, "producer queue registration");
+					m_vecQueues.push_back(pQueue);
+					m_bQueuesChanged.store(true);
+				}
+				t_registration.pQueue = std::move(pQueue);
+				t_registration.ownerId = m_id;
+			}
+			return *t_registration.pQueue;
+		}
+
+		Buffers& beginProducing(Queue& queue) {
+			// If the epoch advanced before the announcement became visible, advance() may not wait for it, so announce again
+			uint64 epoch = m_epoch.load();
+			while ( true ) {
+				queue.activeEpoch.store(epoch);
+				uint64 current = m_epoch.load();
+				if ( current == epoch )
+					break;
+				epoch = current;
+			}
+			return queue.buffers[epoch & 1];
+		}
+
+		// Ids instead of addresses, a new instance at the address of a destroyed one must not use its queues
+		static inline std::atomic<uint64> s_nextId = 1;
+		const uint64 m_id = s_nextId.fetch_add(1);
+
+		std::mutex m_mutex;
+		std::vector<std::shared_ptr<Queue>> m_vecQueues;
+		std::atomic<bool> m_bQueuesChanged = false;
+		std::atomic<uint64> m_epoch = 0;
+
+		// Consumer side copy of the registered queues and the parity of the buffers taken by the last advance
+		std::vector<Queue*> m_vecTakenQueues;
+		uint32 m_takenParity = 0;
+};
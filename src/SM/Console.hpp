@@ -2,6 +2,7 @@
 
 #include <string>
 #include <format>
+#include <stdexcept>
 
 #include "Types.hpp"
 
@@ -11,12 +11,27 @@ namespace SM {
 			inline static DebugDrawer* Get() {return RenderStateManager::Get()->getDebugDrawer();}
 
 			inline SRWLock& getLock() {return m_lock;};
+			inline LineVertexArray& getLineVertices() {return m_lineVertices;};
 
 			inline void drawLine(const Vec3& begin, const Vec3& end, u8Vec3 color) {
 				m_lineVertices.push(begin, color);
 				m_lineVertices.push(end, color);
 			};
 
+			inline void drawVertices(const LineVertex* pVertices, uint32 count) {
+				m_lineVertices.push(pVertices, count);
+			};
+
+			// Adds count vertices to the lines to draw and returns them for the caller to fill
+			inline LineVertex* appendVertices(uint32 count) {
+				return m_lineVertices.append(count);
+			};
+
+			// Makes room for the given number of additional vertices
+			inline void reserveVertices(uint32 count) {
+				m_lineVertices.reserve(m_lineVertices.size() + count);
+			};
+
 		private:
 			char _pad0[0x148];
 			SRWLock m_lock;
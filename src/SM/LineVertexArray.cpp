@@ -1,4 +1,7 @@
 
+#include <algorithm>
+#include <cstring>
+
 #include "LineVertexArray.hpp"
 #include "Console.hpp"
 
@@ -7,19 +10,40 @@ using namespace SM;
 #pragma warning(disable: 6001)
 #pragma warning(disable: 6386)
 
-void LineVertexArray::push(const Vec3& point, u8Vec3 color) {
-	if ( m_pArrVertices == nullptr ) {
-		m_pArrVertices = new LineVertex[10];
-		m_capacity = 10;
-		SM_ASSERT(m_pArrVertices);
-	}
-	if ( m_size >= m_capacity ) {
-		m_capacity *= 1.5;
-		LineVertex* pArrNewVertices = new LineVertex[m_capacity];
-		SM_ASSERT(pArrNewVertices);
-		memcpy(pArrNewVertices, m_pArrVertices, (m_size - 1) * sizeof(LineVertex));
+void LineVertexArray::reserve(uint32 capacity) {
+	if ( capacity <= m_capacity && m_pArrVertices != nullptr )
+		return;
+	LineVertex* pArrNewVertices = new LineVertex[capacity];
+	SM_ASSERT(pArrNewVertices);
+	if ( m_pArrVertices != nullptr ) {
+		memcpy(pArrNewVertices, m_pArrVertices, m_size * sizeof(LineVertex));
 		delete[] m_pArrVertices;
-		m_pArrVertices = pArrNewVertices;
 	}
-	m_pArrVertices[m_size++] = {point, {0xFF, color.b, color.g, color.r}};
+	m_pArrVertices = pArrNewVertices;
+	m_capacity = capacity;
+}
+
+void LineVertexArray::push(const LineVertex& vertex) {
+	if ( m_pArrVertices == nullptr )
+		reserve(10);
+	else if ( m_size >= m_capacity )
+		reserve(uint32(m_capacity * 1.5));
+	m_pArrVertices[m_size++] = vertex;
+}
+
+void LineVertexArray::push(const LineVertex* pVertices, uint32 count) {
+	if ( count == 0 )
+		return;
+	if ( m_pArrVertices == nullptr || m_size + count > m_capacity )
+		reserve(std::max(m_size + count, uint32(m_capacity * 1.5)));
+	memcpy(m_pArrVertices + m_size, pVertices, count * sizeof(LineVertex));
+	m_size += count;
+}
+
+LineVertex* LineVertexArray::append(uint32 count) {
+	if ( m_pArrVertices == nullptr || m_size + count > m_capacity )
+		reserve(std::max(m_size + count, uint32(m_capacity * 1.5)));
+	LineVertex* pVertices = m_pArrVertices + m_size;
+	m_size += count;
+	return pVertices;
 }
@@ -7,10 +7,30 @@ namespace SM {
 		Vec3 point;
 		u8Vec4 color;
 	};
+
+	// Converts an RGB color to the channel order used by LineVertex
+	inline u8Vec4 ToLineVertexColor(u8Vec3 color) {
+		return {0xFF, color.b, color.g, color.r};
+	}
+
 	class LineVertexArray {
 		public:
 
-			void push(const Vec3& point, u8Vec3 color);
+			inline uint32 size() const {return m_size;};
+			inline uint32 capacity() const {return m_capacity;};
+			inline const LineVertex* data() const {return m_pArrVertices;};
+			// Drops all vertices and keeps the capacity, like the game does once it drew them
+			inline void clear() {m_size = 0;};
+
+			// Grows the capacity to at least the given vertex count
+			void reserve(uint32 capacity);
+
+			void push(const LineVertex& vertex);
+			void push(const LineVertex* pVertices, uint32 count);
+			inline void push(const Vec3& point, u8Vec3 color) {push({point, ToLineVertexColor(color)});};
+
+			// Grows the array by count vertices and returns the first of them, the caller has to fill all of them
+			LineVertex* append(uint32 count);
 
 		private:
 			LineVertex* m_pArrVertices = nullptr;
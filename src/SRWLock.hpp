@@ -3,15 +3,31 @@
 #define WIN32_LEAN_AND_MEAN
 #include "Windows.h"
 
-#pragma warning(disable: 26110)	// Caller failing to hold lock before calling ReleaseSRWLockShared
+#pragma warning(disable: 26110)	// Caller failing to hold lock before calling ReleaseSRWLock*
 
 namespace SM {
+	// Wraps the game's SRWLOCK, so it can't hold anything else.
+	// lock() is exclusive and must be used for writing, lock_shared() only allows reading.
+	// Works with std::scoped_lock / std::unique_lock (exclusive) and std::shared_lock (shared).
 	class SRWLock {
 		public:
 			void lock() {
-				AcquireSRWLockShared(&m_lock);
+				AcquireSRWLockExclusive(&m_lock);
+			}
+			bool try_lock() {
+				return TryAcquireSRWLockExclusive(&m_lock) != 0;
 			}
 			void unlock() {
+				ReleaseSRWLockExclusive(&m_lock);
+			}
+
+			void lock_shared() {
+				AcquireSRWLockShared(&m_lock);
+			}
+			bool try_lock_shared() {
+				return TryAcquireSRWLockShared(&m_lock) != 0;
+			}
+			void unlock_shared() {
 				ReleaseSRWLockShared(&m_lock);
 			}
 
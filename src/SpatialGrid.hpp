@@ -0,0 +1,193 @@
+#pragma once
+
+#include <vector>
+
+#include "NullHash.hpp"
+#include "Frustum.hpp"
+#include "Types.hpp"
+
+// Loose uniform grid over bounding spheres.
+// Items are stored in the cell containing their center, each cell grows its bounds by the largest item radius inside of it.
+template <typename K>
+class SpatialGrid {
+	public:
+		static constexpr float CellSize = 32.0f;
+
+		inline uint32 size() const {return uint32(m_mapLocations.size());};
+
+		// Key must not already exist
+		void insert(K key, const BoundingSphere& bounds) {
+			uint32 cellIndex = getOrCreateCell(bounds.center);
+			Cell& cell = m_vecCells[cellIndex];
+			m_mapLocations.emplace(key, Location(cellIndex, uint32(cell.items.size())));
+			cell.items.emplace_back(key, bounds);
+			if ( bounds.radius > cell.maxRadius )
+				cell.maxRadius = bounds.radius;
+			if ( bounds.radius > m_maxRadius )
+				m_maxRadius = bounds.radius;
+		}
+
+		void update(K key, const BoundingSphere& bounds) {
+			auto it = m_mapLocations.find(key);
+			if ( it == m_mapLocations.end() )
+				return insert(key, bounds);
+
+			Location& loc = it->second;
+			Cell& cell = m_vecCells[loc.cell];
+			if ( cell.coord == GetCellCoord(bounds.center) ) {
+				cell.items[loc.item].bounds = bounds;
+				if ( bounds.radius > cell.maxRadius )
+					cell.maxRadius = bounds.radius;
+				if ( bounds.radius > m_maxRadius )
+					m_maxRadius = bounds.radius;
+				return;
+			}
+			removeItem(loc);
+			m_mapLocations.erase(it);
+			insert(key, bounds);
+		}
+
+		void remove(K key) {
+			auto it = m_mapLocations.find(key);
+			if ( it == m_mapLocations.end() )
+				return;
+			removeItem(it->second);
+			m_mapLocations.erase(it);
+		}
+
+		void clear() {
+			m_mapCells.clear();
+			m_vecCells.clear();
+			m_mapLocations.clear();
+			m_minCoord = i32Vec3(0);
+			m_maxCoord = i32Vec3(0);
+			m_maxRadius = 0.0f;
+		}
+
+		// Calls func(key) for every item intersecting the frustum.
+		// Only cells whose items can reach into the frustum's bounding box are visited, either by looking up every cell coordinate
+		// in that box or, if the box is large compared to the number of cells, by walking all cells and skipping the ones outside of it.
+		template <typename Func>
+		void query(const Frustum& frustum, Func func) const {
+			if ( m_vecCells.empty() )
+				return;
+
+			// Items are stored by their center, so they can reach into the box from up to the largest radius outside of it
+			i32Vec3 first = glm::clamp(GetCellCoord(frustum.getMin() - m_maxRadius), m_minCoord, m_maxCoord);
+			i32Vec3 last = glm::clamp(GetCellCoord(frustum.getMax() + m_maxRadius), m_minCoord, m_maxCoord);
+			uint64 rangeCells = uint64(last.x - first.x + 1) * uint64(last.y - first.y + 1) * uint64(last.z - first.z + 1);
+
+			// Looking a cell up costs several times more than skipping it during the walk
+			if ( rangeCells * 8 < m_vecCells.size() ) {
+				for ( int32 z = first.z; z <= last.z; ++z ) {
+					for ( int32 y = first.y; y <= last.y; ++y ) {
+						for ( int32 x = first.x; x <= last.x; ++x ) {
+							auto it = m_mapCells.find(GetCellKey({x, y, z}));
+							if ( it != m_mapCells.end() )
+								queryCell(m_vecCells[it->second], frustum, func);
+						}
+					}
+				}
+				return;
+			}
+
+			for ( const Cell& cell : m_vecCells ) {
+				if ( glm::any(glm::lessThan(cell.coord, first)) || glm::any(glm::greaterThan(cell.coord, last)) )
+					continue;
+				queryCell(cell, frustum, func);
+			}
+		}
+
+	private:
+		static constexpr float CellHalfDiagonal = CellSize * 0.8660254f;
+
+		struct Item {
+			K key;
+			BoundingSphere bounds;
+		};
+
+		struct Cell {
+			i32Vec3 coord;
+			float maxRadius;
+			std::vector<Item> items;
+		};
+
+		struct Location {
+			uint32 cell;
+			uint32 item;
+		};
+
+		template <typename Func>
+		static void queryCell(const Cell& cell, const Frustum& frustum, Func& func) {
+			Vec3 center = (Vec3(cell.coord) + 0.5f) * CellSize;
+			if ( !frustum.intersects({center, CellHalfDiagonal + cell.maxRadius}) )
+				return;
+			for ( const Item& item : cell.items ) {
+				if ( frustum.intersects(item.bounds) )
+					func(item.key);
+			}
+		}
+
+		static i32Vec3 GetCellCoord(const Vec3& position) {
+			return i32Vec3(glm::floor(position / CellSize));
+		}
+
+		// 21 bits per axis
+		static uint64 GetCellKey(const i32Vec3& coord) {
+			return (uint64(coord.x) & 0x1FFFFF) | ((uint64(coord.y) & 0x1FFFFF) << 21) | ((uint64(coord.z) & 0x1FFFFF) << 42);
+		}
+
+		uint32 getOrCreateCell(const Vec3& position) {
+			i32Vec3 coord = GetCellCoord(position);
+			auto [it, inserted] = m_mapCells.try_emplace(GetCellKey(coord), uint32(m_vecCells.size()));
+			if ( !inserted )
+				return it->second;
+			if ( m_vecCells.empty() && m_mapCells.size() == 1 ) {
+				m_minCoord = coord;
+				m_maxCoord = coord;
+			} else {
+				for ( int32 axis = 0; axis < 3; ++axis ) {
+					if ( coord[axis] < m_minCoord[axis] )
+						m_minCoord[axis] = coord[axis];
+					if ( coord[axis] > m_maxCoord[axis] )
+						m_maxCoord[axis] = coord[axis];
+				}
+			}
+			m_vecCells.emplace_back(coord, 0.0f);
+			return it->second;
+		}
+
+		// Location must be erased from m_mapLocations afterwards
+		void removeItem(const Location& loc) {
+			Cell& cell = m_vecCells[loc.cell];
+			uint32 lastItem = uint32(cell.items.size() - 1);
+			if ( loc.item != lastItem ) {
+				cell.items[loc.item] = cell.items[lastItem];
+				m_mapLocations[cell.items[loc.item].key].item = loc.item;
+			}
+			cell.items.pop_back();
+
+			if ( !cell.items.empty() )
+				return;
+
+			// Swap the last cell into the empty one
+			m_mapCells.erase(GetCellKey(cell.coord));
+			uint32 lastCell = uint32(m_vecCells.size() - 1);
+			if ( loc.cell != lastCell ) {
+				m_vecCells[loc.cell] = std::move(m_vecCells[lastCell]);
+				Cell& moved = m_vecCells[loc.cell];
+				m_mapCells[GetCellKey(moved.coord)] = loc.cell;
+				for ( const Item& item : moved.items )
+					m_mapLocations[item.key].cell = loc.cell;
+			}
+			m_vecCells.pop_back();
+		}
+
+		NullHashMap<uint64, uint32> m_mapCells;
+		std::vector<Cell> m_vecCells;
+		NullHashMap<K, Location> m_mapLocations;
+		// Bounds of all cells and the largest item radius since the last clear, they don't shrink when items are removed
+		i32Vec3 m_minCoord = i32Vec3(0);
+		i32Vec3 m_maxCoord = i32Vec3(0);
+		float m_maxRadius = 0.0f;
+};
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <vector>
+
+#include "Types.hpp"
+
+// Hierarchical timer wheel, scheduling and expiring entries in O(1) amortized time.
+// Time is measured in ticks and only moves forward when the owner calls advance().
+// Entries far in the future sit in coarser levels and are moved down as their time comes closer.
+template <typename T>
+class TimerWheel {
+	public:
+		static constexpr uint32 SlotBits = 6;
+		static constexpr uint32 SlotCount = 1 << SlotBits;
+		static constexpr uint32 LevelCount = 4;
+
+		inline uint64 now() const {return m_now;};
+		inline uint32 size() const {return m_size;};
+
+		// Entries due at or before the current tick expire on the next advance
+		void schedule(uint64 expireTick, const T& value) {
+			if ( expireTick <= m_now )
+				expireTick = m_now + 1;
+			insert({expireTick, value});
+			++m_size;
+		}
+
+		// Calls func(expireTick, value) for every entry that expires up to and including tick
+		template <typename Func>
+		void advance(uint64 tick, Func func) {
+			while ( m_now < tick ) {
+				++m_now;
+
+				// Move the entries of every level whose current slot just started down, coarsest first
+				uint32 wrapped = 1;
+				while ( wrapped < LevelCount && (m_now & ((uint64(1) << (wrapped * SlotBits)) - 1)) == 0 )
+					++wrapped;
+				for ( uint32 level = wrapped - 1; level > 0; --level )
+					cascade(level);
+
+				std::vector<Entry>& slot = m_arrSlots[0][m_now & (SlotCount - 1)];
+				if ( slot.empty() )
+					continue;
+				m_vecDue.swap(slot);
+				m_size -= uint32(m_vecDue.size());
+				for ( const Entry& entry : m_vecDue )
+					func(entry.expireTick, entry.value);
+				m_vecDue.clear();
+			}
+		}
+
+		void clear() {
+			for ( auto& level : m_arrSlots ) {
+				for ( std::vector<Entry>& slot : level )
+					slot.clear();
+			}
+			m_size = 0;
+		}
+
+	private:
+		struct Entry {
+			uint64 expireTick;
+			T value;
+		};
+
+		void insert(const Entry& entry) {
+			uint64 delta = entry.expireTick - m_now;
+			uint32 level = 0;
+			while ( level < LevelCount - 1 && delta >= (uint64(1) << ((level + 1) * SlotBits)) )
+				++level;
+			// Entries beyond the last level come back around and are inserted again
+			uint64 slot = (entry.expireTick >> (level * SlotBits)) & (SlotCount - 1);
+			m_arrSlots[level][slot].push_back(entry);
+		}
+
+		void cascade(uint32 level) {
+			std::vector<Entry>& slot = m_arrSlots[level][(m_now >> (level * SlotBits)) & (SlotCount - 1)];
+			if ( slot.empty() )
+				return;
+			m_vecCascade.swap(slot);
+			for ( const Entry& entry : m_vecCascade )
+				insert(entry);
+			m_vecCascade.clear();
+		}
+
+		uint64 m_now = 0;
+		uint32 m_size = 0;
+		std::vector<Entry> m_arrSlots[LevelCount][SlotCount];
+		std::vector<Entry> m_vecDue;
+		std::vector<Entry> m_vecCascade;
+};
@@ -5,12 +5,15 @@
 #include "glm/glm.hpp"
 #include "glm/gtc/quaternion.hpp"
 
+using Vec4 = glm::vec4;
 using Vec3 = glm::vec3;
 using Vec2 = glm::vec2;
 using i32Vec3 = glm::i32vec3;
 using u8Vec3 = glm::u8vec3;
 using u8Vec4 = glm::u8vec4;
 using Quat = glm::quat;
+using Mat3 = glm::mat3;
+using Mat4 = glm::mat4;
 
 using int8 = int8_t;
 using uint8 = uint8_t;
@@ -0,0 +1,62 @@
+#include "WorkerPool.hpp"
+
+WorkerPool::WorkerPool(uint32 threadCount) {
+	for ( uint32 i = 1; i < threadCount; ++i )
+		m_vecThreads.emplace_back(&WorkerPool::workerMain, this);
+}
+
+WorkerPool::~WorkerPool() {
+	{
+		std::scoped_lock lock(m_mutex);
+		m_bStop = true;
+	}
+	m_cvStart.notify_all();
+	for ( std::thread& thread : m_vecThreads )
+		thread.join();
+}
+
+void WorkerPool::run(uint32 count, uint32 grainSize, InvokeFunc invoke, void* pFunc) {
+	{
+		std::scoped_lock lock(m_mutex);
+		m_invoke = invoke;
+		m_pFunc = pFunc;
+		m_count = count;
+		m_grainSize = grainSize;
+		m_nextIndex = 0;
+		m_busyWorkers = uint32(m_vecThreads.size());
+		++m_generation;
+	}
+	m_cvStart.notify_all();
+
+	runRanges();
+
+	std::unique_lock lock(m_mutex);
+	m_cvDone.wait(lock, [this] {return m_busyWorkers == 0;});
+}
+
+void WorkerPool::runRanges() {
+	uint32 begin;
+	while ( (begin = m_nextIndex.fetch_add(m_grainSize)) < m_count ) {
+		uint32 end = (m_count - begin > m_grainSize ? begin + m_grainSize : m_count);
+		m_invoke(m_pFunc, begin, end);
+	}
+}
+
+void WorkerPool::workerMain() {
+	uint64 generation = 0;
+	while ( true ) {
+		{
+			std::unique_lock lock(m_mutex);
+			m_cvStart.wait(lock, [&] {return m_bStop || m_generation != generation;});
+			if ( m_bStop )
+				return;
+			generation = m_generation;
+		}
+
+		runRanges();
+
+		std::scoped_lock lock(m_mutex);
+		if ( --m_busyWorkers == 0 )
+			m_cvDone.notify_one();
+	}
+}
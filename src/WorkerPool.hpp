@@ -0,0 +1,56 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+#include "Types.hpp"
+
+// Fixed set of threads running parallel loops, the thread calling parallelFor takes part as well.
+// Only one thread may call parallelFor at a time.
+class WorkerPool {
+	public:
+		// Starts threadCount - 1 additional threads
+		WorkerPool(uint32 threadCount);
+		~WorkerPool();
+
+		WorkerPool(const WorkerPool&) = delete;
+		WorkerPool& operator=(const WorkerPool&) = delete;
+
+		inline uint32 getThreadCount() const {return uint32(m_vecThreads.size()) + 1;};
+
+		// Calls func(begin, end) for ranges of up to grainSize indices covering [0, count) and returns once all of them are done
+		template <typename Func>
+		void parallelFor(uint32 count, uint32 grainSize, Func& func) {
+			if ( count <= grainSize || m_vecThreads.empty() ) {
+				if ( count != 0 )
+					func(0, count);
+				return;
+			}
+			run(count, grainSize, [](void* pFunc, uint32 begin, uint32 end) {(*static_cast<Func*>(pFunc))(begin, end);}, &func);
+		}
+
+	private:
+		using InvokeFunc = void(*)(void* pFunc, uint32 begin, uint32 end);
+
+		void run(uint32 count, uint32 grainSize, InvokeFunc invoke, void* pFunc);
+		void runRanges();
+		void workerMain();
+
+		std::vector<std::thread> m_vecThreads;
+		std::mutex m_mutex;
+		std::condition_variable m_cvStart;
+		std::condition_variable m_cvDone;
+		uint64 m_generation = 0;
+		uint32 m_busyWorkers = 0;
+		bool m_bStop = false;
+
+		// The current loop, only written while no worker is busy
+		InvokeFunc m_invoke = nullptr;
+		void* m_pFunc = nullptr;
+		uint32 m_count = 0;
+		uint32 m_grainSize = 0;
+		std::atomic<uint32> m_nextIndex = 0;
+};
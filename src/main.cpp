@@ -67,6 +67,8 @@ static void H_PlayState_Cleanup(void* self) {
 		g_State.setInjectedLuaStates.clear();
 	}
 	g_debugDrawManager->clear();
+	// Stopped here instead of by the manager's destructor, which runs in DllMain where the threads can't exit
+	g_debugDrawManager->stopWorkers();
 	O_PlayState_Cleanup(self);
 }
 
@@ -148,6 +150,8 @@ static bool Attach() {
 }
 
 static void Detach() {
+	// Joining them under the loader lock could deadlock, the destructor must not find any
+	g_State.debugDrawManager.abandonWorkers();
 	if ( g_State.bMhInitialized ) {
 		g_State.bMhInitialized = false;
 		MH_Uninitialize();
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdio>
+
+#include "Types.hpp"
+
+// Failed checks are counted instead of stopping the test, so one run reports all of them
+inline uint32 g_checkFailures = 0;
+
+#define CHECK(cond) \
+	do { \
+		if ( !(cond) ) { \
+			printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+			++g_checkFailures; \
+		} \
+	} while ( false )
+
+// Prints the outcome and returns the exit code for main
+inline int ReportChecks(const char* testName) {
+	if ( g_checkFailures != 0 ) {
+		printf("%u checks failed\n", g_checkFailures);
+		return 1;
+	}
+	printf("All %s tests passed\n", testName);
+	return 0;
+}
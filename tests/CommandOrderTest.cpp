@@ -0,0 +1,122 @@
+// Tests that commands pushed from different threads are applied in the order they were pushed,
+// also when repeated updates of a shape are merged into a command that is still pending.
+
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "DebugDrawManager.hpp"
+#include "TestDrawer.hpp"
+#include "Check.hpp"
+
+// Runs functions on its own thread, one at a time. run() returns once the function is done.
+class TestThread {
+	public:
+		TestThread() : m_thread(&TestThread::threadMain, this) {};
+		~TestThread() {
+			run(nullptr);
+			m_thread.join();
+		}
+
+		void run(std::function<void()> func) {
+			std::unique_lock lock(m_mutex);
+			m_func = std::move(func);
+			m_bPending = true;
+			m_cv.notify_all();
+			m_cv.wait(lock, [this] {return !m_bPending;});
+		}
+
+	private:
+		void threadMain() {
+			while ( true ) {
+				std::unique_lock lock(m_mutex);
+				m_cv.wait(lock, [this] {return m_bPending;});
+				if ( !m_func ) {
+					m_bPending = false;
+					m_cv.notify_all();
+					return;
+				}
+				m_func();
+				m_bPending = false;
+				m_cv.notify_all();
+			}
+		}
+
+		std::mutex m_mutex;
+		std::condition_variable m_cv;
+		std::function<void()> m_func;
+		bool m_bPending = false;
+		std::thread m_thread;
+};
+
+static const Vec3 ArrowBegin(0.0f, 0.0f, 0.0f);
+static const Vec3 ArrowEnd(1.0f, 0.0f, 0.0f);
+static const u8Vec3 White(255, 255, 255);
+
+// A remove from another thread lands between two adds of the same arrow, the second add is merged into the first
+static void TestRemoveBetweenMergedAdds(TestDrawer& drawer) {
+	DebugDrawManager manager;
+	TestThread threadA, threadB;
+	threadA.run([&] {manager.addArrow("x", ArrowBegin, ArrowEnd, White);});
+	threadB.run([&] {manager.removeArrow("x");});
+	threadA.run([&] {manager.addArrow("x", ArrowBegin, ArrowEnd, White);});
+	manager.render();
+	CHECK(drawer.take() == ArrowVertexCount);
+}
+
+// Same with a full clear, like H_PlayState_Cleanup pushes while scripts keep adding their shapes
+static void TestClearBetweenMergedAdds(TestDrawer& drawer) {
+	DebugDrawManager manager;
+	TestThread threadA, threadB;
+	threadA.run([&] {
+		manager.addArrow("x", ArrowBegin, ArrowEnd, White);
+		manager.addSphere("y", ArrowBegin, 1.0f, White);
+	});
+	threadB.run([&] {manager.clear();});
+	threadA.run([&] {manager.addArrow("x", ArrowBegin, ArrowEnd, White);});
+	manager.render();
+	// The sphere was cleared, the arrow added again
+	CHECK(drawer.take() == ArrowVertexCount);
+}
+
+// Without a second add the remove wins
+static void TestRemoveAfterAdd(TestDrawer& drawer) {
+	DebugDrawManager manager;
+	TestThread threadA, threadB;
+	threadA.run([&] {manager.addArrow("x", ArrowBegin, ArrowEnd, White);});
+	threadB.run([&] {manager.removeArrow("x");});
+	manager.render();
+	CHECK(drawer.take() == 0);
+}
+
+// Many merged updates on one thread interleaved with commands of another.
+// The old numbers of the merged commands leave the order mostly gaps, which sorts instead of placing commands into slots.
+static void TestManyMergedUpdates(TestDrawer& drawer) {
+	DebugDrawManager manager;
+	TestThread threadA, threadB;
+	for ( uint32 round = 0; round < 100; ++round ) {
+		threadA.run([&] {
+			for ( uint32 i = 0; i < 100; ++i )
+				manager.addArrow("a" + std::to_string(i), ArrowBegin, ArrowEnd, White);
+		});
+		threadB.run([&] {
+			manager.removeArrow("a" + std::to_string(round % 100));
+			manager.addArrow("b" + std::to_string(round), ArrowBegin, ArrowEnd, White);
+		});
+	}
+	threadA.run([&] {manager.addArrow("a99", ArrowBegin, ArrowEnd, White);});
+	manager.render();
+	// Every a was added again after its remove, except a99 was removed last and then added once more
+	CHECK(drawer.take() == 200 * ArrowVertexCount);
+}
+
+int main() {
+	TestDrawer drawer;
+	TestRemoveBetweenMergedAdds(drawer);
+	TestClearBetweenMergedAdds(drawer);
+	TestRemoveAfterAdd(drawer);
+	TestManyMergedUpdates(drawer);
+
+	return ReportChecks("CommandOrder");
+}
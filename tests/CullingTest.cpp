@@ -0,0 +1,221 @@
+// Tests of the view culling, SpatialGrid::query with a Frustum against checking every sphere against the camera's planes.
+// Testing a sphere against each plane on its own also accepts some spheres just outside of the frustum's corners, which the grid
+// may or may not cull. So the grid has to return every sphere that really reaches into the frustum, and none the planes reject.
+
+#include <vector>
+#include <set>
+#include <random>
+
+#include "glm/gtc/matrix_transform.hpp"
+
+#include "SpatialGrid.hpp"
+#include "Check.hpp"
+
+using Grid = SpatialGrid<uint32>;
+
+struct Camera {
+	Vec3 position;
+	Vec3 direction;
+	float fov;	// Vertical, in degrees
+	float aspect;
+	float farPlane;
+};
+
+static constexpr float NearPlane = 0.05f;
+
+// Built the same way DebugDrawManager::updateCamera does
+static Frustum MakeFrustum(const Camera& camera) {
+	Vec3 dir = glm::normalize(camera.direction);
+	Vec3 up = (glm::abs(dir.z) > 0.99f ? Vec3(0.0f, 1.0f, 0.0f) : Vec3(0.0f, 0.0f, 1.0f));
+	Mat4 view = glm::lookAt(camera.position, camera.position + dir, up);
+	Mat4 projection = glm::perspective(glm::radians(camera.fov), camera.aspect, NearPlane, camera.farPlane);
+	return Frustum(projection * view);
+}
+
+// Inwards facing planes through the camera's position, worked out from its axes instead of the matrix
+struct ReferenceFrustum {
+	Vec3 position;
+	Vec3 forward;
+	float farPlane;
+	Vec3 arrNormals[6];
+	float arrDistances[6];
+
+	ReferenceFrustum(const Camera& camera) : position(camera.position), farPlane(camera.farPlane) {
+		forward = glm::normalize(camera.direction);
+		Vec3 up = (glm::abs(forward.z) > 0.99f ? Vec3(0.0f, 1.0f, 0.0f) : Vec3(0.0f, 0.0f, 1.0f));
+		Vec3 right = glm::normalize(glm::cross(forward, up));
+		up = glm::cross(right, forward);
+		float tanVertical = glm::tan(glm::radians(camera.fov) * 0.5f);
+		float tanHorizontal = tanVertical * camera.aspect;
+
+		arrNormals[0] = glm::normalize(right + forward * tanHorizontal);
+		arrNormals[1] = glm::normalize(-right + forward * tanHorizontal);
+		arrNormals[2] = glm::normalize(up + forward * tanVertical);
+		arrNormals[3] = glm::normalize(-up + forward * tanVertical);
+		arrNormals[4] = forward;
+		arrNormals[5] = -forward;
+		for ( uint32 i = 0; i < 4; ++i )
+			arrDistances[i] = -glm::dot(arrNormals[i], camera.position);
+		arrDistances[4] = -glm::dot(forward, camera.position) - NearPlane;
+		arrDistances[5] = glm::dot(forward, camera.position) + camera.farPlane;
+	}
+
+	// Whether the sphere grown by margin reaches into every plane's inside
+	bool intersectsPlanes(const BoundingSphere& sphere, float margin) const {
+		for ( uint32 i = 0; i < 6; ++i ) {
+			if ( glm::dot(arrNormals[i], sphere.center) + arrDistances[i] < -(sphere.radius + margin) )
+				return false;
+		}
+		return true;
+	}
+
+	bool contains(const Vec3& point, float margin) const {
+		for ( uint32 i = 0; i < 6; ++i ) {
+			if ( glm::dot(arrNormals[i], point) + arrDistances[i] < margin )
+				return false;
+		}
+		return true;
+	}
+
+	// Whether the sphere's point closest to the view axis is at least margin inside the frustum.
+	// Misses some spheres that only reach into a corner, but never accepts one that is outside.
+	bool containsPointOf(const BoundingSphere& sphere, float margin) const {
+		Vec3 axisPoint = position + forward * glm::clamp(glm::dot(sphere.center - position, forward), NearPlane, farPlane);
+		Vec3 offset = axisPoint - sphere.center;
+		float distance = glm::length(offset);
+		Vec3 point = (distance <= sphere.radius ? axisPoint : sphere.center + offset * (sphere.radius / distance));
+		return contains(point, margin);
+	}
+};
+
+struct Scene {
+	Grid grid;
+	std::vector<BoundingSphere> vecItems;
+	std::vector<bool> vecRemoved;
+
+	void insert(const BoundingSphere& bounds) {
+		grid.insert(uint32(vecItems.size()), bounds);
+		vecItems.push_back(bounds);
+		vecRemoved.push_back(false);
+	}
+};
+
+// Counts the spheres the grid returned, and those of them whose centers are outside of the frustum
+static void CheckCamera(const Scene& scene, const Camera& camera, uint32& visibleCount, uint32& straddlingCount) {
+	Frustum frustum = MakeFrustum(camera);
+	ReferenceFrustum reference(camera);
+	// Rounding grows with the distance from the origin
+	float margin = 1e-4f * (camera.farPlane + glm::length(camera.position) + 100.0f);
+
+	std::set<uint32> setQueried;
+	bool bUnique = true;
+	scene.grid.query(frustum, [&](uint32 key) {bUnique &= setQueried.insert(key).second;});
+	CHECK(bUnique);
+
+	bool bNoneOutside = true;
+	bool bAllInside = true;
+	for ( uint32 key = 0; key < scene.vecItems.size(); ++key ) {
+		const BoundingSphere& bounds = scene.vecItems[key];
+		bool bQueried = setQueried.contains(key);
+		if ( scene.vecRemoved[key] ) {
+			bNoneOutside &= !bQueried;
+			continue;
+		}
+		if ( bQueried ) {
+			bNoneOutside &= frustum.intersects(bounds) && reference.intersectsPlanes(bounds, margin);
+			++visibleCount;
+			straddlingCount += (reference.contains(bounds.center, 0.0f) ? 0 : 1);
+		} else
+			bAllInside &= !reference.containsPointOf(bounds, margin);
+	}
+	CHECK(bNoneOutside);
+	CHECK(bAllInside);
+}
+
+static const Camera Cameras[] = {
+	{Vec3(0.0f), Vec3(1.0f, 0.0f, 0.0f), 70.0f, 16.0f / 9.0f, 100000.0f},
+	{Vec3(0.0f), Vec3(1.0f, 0.0f, 0.0f), 70.0f, 16.0f / 9.0f, 60.0f},
+	{Vec3(-40.5f, 17.0f, -3.0f), Vec3(-1.0f, -2.0f, 0.5f), 50.0f, 4.0f / 3.0f, 150.0f},
+	{Vec3(100.0f, -100.0f, 20.0f), Vec3(-1.0f, 1.0f, -0.2f), 90.0f, 16.0f / 9.0f, 1000.0f},
+	// Straight up and straight down, where the up vector has to be swapped
+	{Vec3(5.0f, 5.0f, -50.0f), Vec3(0.0f, 0.0f, 1.0f), 60.0f, 1.0f, 200.0f},
+	{Vec3(-64.0f, 32.0f, 96.0f), Vec3(0.0f, 0.0f, -1.0f), 100.0f, 2.0f, 80.0f},
+	// Narrow view along a cell border
+	{Vec3(32.0f, 0.0f, 0.0f), Vec3(0.0f, 1.0f, 0.0f), 5.0f, 1.0f, 500.0f},
+	// Far outside of all items
+	{Vec3(5000.0f, 0.0f, 0.0f), Vec3(1.0f, 0.0f, 0.0f), 70.0f, 1.0f, 1000.0f}
+};
+
+static void TestCameras() {
+	Scene scene;
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<float> position(-300.0f, 300.0f);
+	std::uniform_real_distribution<float> smallRadius(0.0f, 3.0f);
+	std::uniform_real_distribution<float> largeRadius(10.0f, 80.0f);
+	for ( uint32 i = 0; i < 20000; ++i )
+		scene.insert({Vec3(position(rng), position(rng), position(rng)), i % 100 == 0 ? largeRadius(rng) : smallRadius(rng)});
+
+	// Centers right at cell borders, on both sides, with spheres reaching into the neighbouring cells
+	std::uniform_int_distribution<int32> cell(-8, 8);
+	for ( uint32 i = 0; i < 2000; ++i ) {
+		Vec3 center = Vec3(float(cell(rng)), float(cell(rng)), float(cell(rng))) * Grid::CellSize;
+		center[i % 3] += (i % 2 == 0 ? -0.001f : 0.0f);
+		scene.insert({center, smallRadius(rng) + (i % 10 == 0 ? Grid::CellSize : 0.0f)});
+	}
+
+	uint32 visibleCount = 0;
+	uint32 straddlingCount = 0;
+	for ( const Camera& camera : Cameras )
+		CheckCamera(scene, camera, visibleCount, straddlingCount);
+	CHECK(visibleCount != 0 && straddlingCount != 0);
+
+	// Huge spheres far away from everything else, which only the loose bounds of their cells let reach the cameras.
+	// They also widen the range of cells every query has to consider, so it walks all cells instead of looking them up.
+	scene.insert({Vec3(0.0f, 0.0f, 900.0f), 880.0f});
+	scene.insert({Vec3(6500.0f, 0.0f, 0.0f), 800.0f});
+	for ( const Camera& camera : Cameras )
+		CheckCamera(scene, camera, visibleCount, straddlingCount);
+
+	// Moving, growing and removing items
+	std::uniform_int_distribution<uint32> item(0, uint32(scene.vecItems.size() - 1));
+	for ( uint32 i = 0; i < 5000; ++i ) {
+		uint32 key = item(rng);
+		if ( scene.vecRemoved[key] )
+			continue;
+		if ( i % 4 == 0 ) {
+			scene.grid.remove(key);
+			scene.vecRemoved[key] = true;
+		} else if ( i % 4 == 1 ) {
+			// Stays in its cell, which has to grow its bounds
+			scene.vecItems[key].radius += largeRadius(rng);
+			scene.grid.update(key, scene.vecItems[key]);
+		} else {
+			scene.vecItems[key].center += Vec3(position(rng), position(rng), position(rng)) * 0.1f;
+			scene.grid.update(key, scene.vecItems[key]);
+		}
+	}
+	for ( const Camera& camera : Cameras )
+		CheckCamera(scene, camera, visibleCount, straddlingCount);
+}
+
+// Only the item whose sphere reaches into the view is returned, although both are stored in cells outside of it
+static void TestLooseCells() {
+	Grid grid;
+	Camera camera = {Vec3(0.0f), Vec3(1.0f, 0.0f, 0.0f), 60.0f, 1.0f, 50.0f};
+	grid.insert(0, {Vec3(20.0f, 0.0f, 100.0f), 90.0f});
+	grid.insert(1, {Vec3(20.0f, 0.0f, 100.0f), 60.0f});
+	// Many cells outside of the view, so the query looks the cells in range up by coordinate
+	for ( uint32 i = 2; i < 1000; ++i )
+		grid.insert(i, {Vec3(float(i) * 64.0f, 5000.0f, 0.0f), 1.0f});
+
+	std::vector<uint32> vecQueried;
+	grid.query(MakeFrustum(camera), [&](uint32 key) {vecQueried.push_back(key);});
+	CHECK(vecQueried.size() == 1 && vecQueried[0] == 0);
+}
+
+int main() {
+	TestCameras();
+	TestLooseCells();
+
+	return ReportChecks("Culling");
+}
@@ -0,0 +1,119 @@
+// Tests of SM::LineVertexArray, the game's array the drawer collects line vertices in.
+
+#include <vector>
+
+#include "SM/LineVertexArray.hpp"
+#include "Check.hpp"
+
+using namespace SM;
+
+static LineVertex MakeVertex(uint32 i) {
+	return {Vec3(float(i), float(i) * 2.0f, -float(i)), u8Vec4(uint8(i), uint8(i >> 8), uint8(i >> 16), 0xFF)};
+}
+
+static bool IsVertex(const LineVertex& vertex, uint32 i) {
+	LineVertex expected = MakeVertex(i);
+	return vertex.point == expected.point && vertex.color == expected.color;
+}
+
+// Every vertex in the array was made by MakeVertex from its index
+static bool HasVertices(const LineVertexArray& array, uint32 count) {
+	if ( array.size() != count )
+		return false;
+	for ( uint32 i = 0; i < count; ++i ) {
+		if ( !IsVertex(array.data()[i], i) )
+			return false;
+	}
+	return true;
+}
+
+static void TestReserve() {
+	LineVertexArray array;
+	array.reserve(100);
+	CHECK(array.capacity() == 100);
+	CHECK(array.size() == 0);
+	const LineVertex* pData = array.data();
+	for ( uint32 i = 0; i < 100; ++i )
+		array.push(MakeVertex(i));
+	// Filling the reserved room never reallocates
+	CHECK(array.data() == pData);
+	CHECK(HasVertices(array, 100));
+
+	// Reserving less than the capacity keeps it
+	array.reserve(50);
+	CHECK(array.capacity() == 100);
+	CHECK(array.data() == pData);
+	array.reserve(1000);
+	CHECK(array.capacity() == 1000);
+	CHECK(HasVertices(array, 100));
+}
+
+// Growing copies every vertex, the last one used to be dropped
+static void TestGrowthKeepsAllVertices() {
+	LineVertexArray array;
+	uint32 growths = 0;
+	for ( uint32 i = 0; i < 10000; ++i ) {
+		uint32 capacity = array.capacity();
+		array.push(MakeVertex(i));
+		if ( array.capacity() != capacity ) {
+			++growths;
+			CHECK(HasVertices(array, i + 1));
+		}
+	}
+	CHECK(growths > 5);
+	CHECK(HasVertices(array, 10000));
+}
+
+static void TestPushBlockAcrossGrowth() {
+	LineVertexArray array;
+	array.reserve(16);
+	for ( uint32 i = 0; i < 10; ++i )
+		array.push(MakeVertex(i));
+
+	// Crosses the capacity, and then a block far larger than the usual growth
+	std::vector<LineVertex> vecVertices;
+	for ( uint32 i = 10; i < 5000; ++i )
+		vecVertices.push_back(MakeVertex(i));
+	array.push(vecVertices.data(), 10);
+	CHECK(array.capacity() >= 20);
+	CHECK(HasVertices(array, 20));
+	array.push(vecVertices.data() + 10, uint32(vecVertices.size()) - 10);
+	CHECK(array.capacity() >= 5000);
+	CHECK(HasVertices(array, 5000));
+
+	array.push(nullptr, 0);
+	CHECK(HasVertices(array, 5000));
+}
+
+static void TestAppend() {
+	LineVertexArray array;
+	for ( uint32 i = 0; i < 7; ++i )
+		array.push(MakeVertex(i));
+
+	// The returned vertices follow the existing ones and are the caller's to fill
+	LineVertex* pVertices = array.append(1000);
+	CHECK(array.size() == 1007);
+	CHECK(array.capacity() >= 1007);
+	CHECK(pVertices == array.data() + 7);
+	for ( uint32 i = 0; i < 1000; ++i )
+		pVertices[i] = MakeVertex(7 + i);
+	CHECK(HasVertices(array, 1007));
+
+	// Appending into reserved room doesn't move the array
+	array.reserve(2000);
+	const LineVertex* pData = array.data();
+	pVertices = array.append(993);
+	CHECK(array.data() == pData);
+	for ( uint32 i = 0; i < 993; ++i )
+		pVertices[i] = MakeVertex(1007 + i);
+	CHECK(HasVertices(array, 2000));
+}
+
+int main() {
+	TestReserve();
+	TestGrowthKeepsAllVertices();
+	TestPushBlockAcrossGrowth();
+	TestAppend();
+
+	return ReportChecks("LineVertexArray");
+}
@@ -0,0 +1,116 @@
+// Stress test of shapes whose names collide, built against DebugDrawCore with only a few bits of every name hash kept.
+// Random adds, removes, re-adds and prefix clears are checked against a reference map after every few operations.
+
+#include <map>
+#include <string>
+#include <random>
+
+#include "DebugDrawManager.hpp"
+#include "IcoSphere.hpp"
+#include "TestDrawer.hpp"
+#include "Check.hpp"
+
+#ifndef DEBUGDRAW_NAME_HASH_BITS
+#error NameCollisionTest needs DEBUGDRAW_NAME_HASH_BITS, otherwise the names hardly ever collide
+#endif
+
+static const Vec3 Origin(0.0f, 0.0f, 0.0f);
+static const Vec3 Forward(1.0f, 0.0f, 0.0f);
+// Level 0 without a camera
+static constexpr float SphereRadius = 0.1f;
+
+// Every add gets a color of its own, so the drawn vertices tell which add each shape came from
+static u8Vec3 GetColor(uint32 id) {
+	return u8Vec3(uint8(id), uint8(id >> 8), uint8(id >> 16));
+}
+
+static uint32 PackColor(u8Vec4 color) {
+	return uint32(color.r) | uint32(color.g) << 8 | uint32(color.b) << 16 | uint32(color.a) << 24;
+}
+
+struct Reference {
+	std::map<std::string, uint32> mapArrows;
+	std::map<std::string, uint32> mapSpheres;
+
+	// Drawn vertices per packed vertex color
+	std::map<uint32, uint32> getVertexCounts(uint32 sphereVertexCount) const {
+		std::map<uint32, uint32> mapCounts;
+		for ( auto& [name, id] : mapArrows )
+			mapCounts[PackColor(SM::ToLineVertexColor(GetColor(id)))] += ArrowVertexCount;
+		for ( auto& [name, id] : mapSpheres )
+			mapCounts[PackColor(SM::ToLineVertexColor(GetColor(id)))] += sphereVertexCount;
+		return mapCounts;
+	}
+
+	void clear(const std::string& prefix) {
+		std::erase_if(mapArrows, [&](const auto& pair) {return pair.first.starts_with(prefix);});
+		std::erase_if(mapSpheres, [&](const auto& pair) {return pair.first.starts_with(prefix);});
+	}
+};
+
+static std::map<uint32, uint32> TakeVertexCounts(TestDrawer& drawer) {
+	std::map<uint32, uint32> mapCounts;
+	const SM::LineVertex* pVertices = drawer.getLineVertices().data();
+	for ( uint32 i = 0; i < drawer.getLineVertices().size(); ++i )
+		++mapCounts[PackColor(pVertices[i].color)];
+	drawer.take();
+	return mapCounts;
+}
+
+// Names from a small set, so adds hit removed and colliding names again and prefixes match many of them
+static std::string GetName(std::mt19937& rng) {
+	return "n" + std::to_string(rng() % 300);
+}
+
+static void TestRandomOperations(TestDrawer& drawer) {
+	constexpr uint32 OperationCount = 200000;
+	constexpr uint32 OperationsPerFrame = 50;
+	const uint32 sphereVertexCount = uint32(IcoSphere(0).getLines().size() * 2);
+
+	DebugDrawManager manager;
+	Reference reference;
+	std::mt19937 rng(1234);
+	uint32 nextId = 0;
+	uint32 mismatchedFrames = 0;
+	for ( uint32 i = 1; i <= OperationCount; ++i ) {
+		uint32 operation = rng() % 100;
+		if ( operation < 35 ) {
+			std::string name = GetName(rng);
+			uint32 id = nextId++;
+			manager.addArrow(name, Origin, Forward, GetColor(id));
+			reference.mapArrows[name] = id;
+		} else if ( operation < 70 ) {
+			std::string name = GetName(rng);
+			uint32 id = nextId++;
+			manager.addSphere(name, Origin, SphereRadius, GetColor(id));
+			reference.mapSpheres[name] = id;
+		} else if ( operation < 83 ) {
+			std::string name = GetName(rng);
+			manager.removeArrow(name);
+			reference.mapArrows.erase(name);
+		} else if ( operation < 96 ) {
+			std::string name = GetName(rng);
+			manager.removeSphere(name);
+			reference.mapSpheres.erase(name);
+		} else {
+			// "n1" also clears "n10" to "n199"
+			std::string prefix = "n" + std::to_string(rng() % 30 + 1);
+			manager.clear(prefix);
+			reference.clear(prefix);
+		}
+
+		if ( i % OperationsPerFrame == 0 ) {
+			manager.render();
+			mismatchedFrames += (TakeVertexCounts(drawer) != reference.getVertexCounts(sphereVertexCount) ? 1 : 0);
+		}
+	}
+	CHECK(mismatchedFrames == 0);
+	CHECK(!reference.mapArrows.empty() && !reference.mapSpheres.empty());
+}
+
+int main() {
+	TestDrawer drawer;
+	TestRandomOperations(drawer);
+
+	return ReportChecks("NameCollision");
+}
@@ -0,0 +1,152 @@
+// Tests of the ProducerQueues handoff, built with and without ThreadSanitizer and with DEBUGDRAW_LOCK_STATS by tests/CMakeLists.txt.
+
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <string_view>
+
+#include "ProducerQueues.hpp"
+#include "Check.hpp"
+
+struct TestBuffers {
+	std::vector<uint64> values;
+};
+
+using TestQueues = ProducerQueues<TestBuffers>;
+
+static void Push(TestQueues& queues, uint64 value) {
+	TestQueues::Producer producer(queues);
+	producer.getBuffers().values.push_back(value);
+}
+
+// Moves everything taken by one advance into vecCounts, indexed by the value
+static void Consume(TestQueues& queues, std::vector<uint32>& vecCounts) {
+	queues.advance();
+	queues.forEachTaken([&](TestBuffers& buffers) {
+		for ( uint64 value : buffers.values )
+			++vecCounts[value];
+		buffers.values.clear();
+	});
+}
+
+// Waves of short lived threads push while the consumer keeps advancing.
+// Every value arrives exactly once, and the queues of the exited threads are freed again.
+// Each wave waits until its queues must be freed before the next one starts, so there are never more queues than threads in a wave.
+static void TestShortLivedThreads() {
+	constexpr uint32 WaveCount = 20;
+	constexpr uint32 ThreadsPerWave = 8;
+	constexpr uint32 PushesPerThread = 500;
+	constexpr uint32 ValueCount = WaveCount * ThreadsPerWave * PushesPerThread;
+
+	TestQueues queues;
+	std::vector<uint32> vecCounts(ValueCount, 0);
+	std::atomic<bool> bDone = false;
+	std::atomic<uint32> advances = 0;
+	std::thread spawner([&] {
+		for ( uint32 wave = 0; wave < WaveCount; ++wave ) {
+			std::vector<std::thread> vecThreads;
+			for ( uint32 i = 0; i < ThreadsPerWave; ++i ) {
+				uint64 first = uint64(wave * ThreadsPerWave + i) * PushesPerThread;
+				uint64 end = first + PushesPerThread;
+				vecThreads.emplace_back([&queues, first, end] {
+					for ( uint64 value = first; value < end; ++value )
+						Push(queues, value);
+				});
+			}
+			for ( std::thread& thread : vecThreads )
+				thread.join();
+			// The advance in progress may miss the new queues, the next ones take them, see them exited and free them
+			uint32 waitUntil = advances + 4;
+			while ( advances < waitUntil )
+				std::this_thread::yield();
+		}
+		bDone = true;
+	});
+
+	uint32 maxQueueCount = 0;
+	while ( !bDone ) {
+		Consume(queues, vecCounts);
+		maxQueueCount = (queues.getQueueCount() > maxQueueCount ? queues.getQueueCount() : maxQueueCount);
+		++advances;
+	}
+	spawner.join();
+	// One advance takes the last values, the next two see the threads exited and free their queues
+	for ( uint32 i = 0; i < 3; ++i )
+		Consume(queues, vecCounts);
+
+	bool bExactlyOnce = true;
+	for ( uint32 count : vecCounts )
+		bExactlyOnce &= count == 1;
+	CHECK(bExactlyOnce);
+	CHECK(maxQueueCount <= ThreadsPerWave);
+	CHECK(queues.getQueueCount() == 0);
+}
+
+// A producer whose write throws still ends its announcement, so the next advance doesn't wait for it
+static void TestThrowingProducer() {
+	TestQueues queues;
+	std::vector<uint32> vecCounts(2, 0);
+	Push(queues, 0);
+	try {
+		TestQueues::Producer producer(queues);
+		producer.getBuffers().values.push_back(1);
+		throw 1;
+	} catch ( int ) {}
+	Consume(queues, vecCounts);
+	CHECK(vecCounts[0] == 1 && vecCounts[1] == 1);
+}
+
+// A thread exiting after the queues it pushed to were destroyed only releases its own reference
+static void TestThreadOutlivesQueues() {
+	std::unique_ptr<TestQueues> pQueues = std::make_unique<TestQueues>();
+	std::atomic<uint32> step = 0;
+	std::thread producer([&] {
+		Push(*pQueues, 0);
+		step = 1;
+		while ( step != 2 )
+			std::this_thread::yield();
+	});
+	while ( step != 1 )
+		std::this_thread::yield();
+	pQueues.reset();
+	step = 2;
+	producer.join();
+}
+
+// A new instance never hands out the queue a thread registered with another one
+static void TestNewInstance() {
+	std::vector<uint32> vecCounts(2, 0);
+	for ( uint64 value = 0; value < 2; ++value ) {
+		TestQueues queues;
+		Push(queues, value);
+		Consume(queues, vecCounts);
+		CHECK(queues.getQueueCount() == 1);
+	}
+	CHECK(vecCounts[0] == 1 && vecCounts[1] == 1);
+}
+
+#ifdef DEBUGDRAW_LOCK_STATS
+// Every place the handoff waits at was timed by the tests above
+static void TestLockStats() {
+	std::vector<LockSite::Snapshot> vecSites = LockSite::GetSnapshots();
+	for ( std::string_view name : {"producer queue registration", "producer queue list", "producer queue free", "producer grace wait"} ) {
+		uint64 acquisitions = 0;
+		for ( const LockSite::Snapshot& site : vecSites )
+			acquisitions += (name == site.name ? site.acquisitions : 0);
+		CHECK(acquisitions != 0);
+	}
+}
+#endif
+
+int main() {
+	TestShortLivedThreads();
+	TestThrowingProducer();
+	TestThreadOutlivesQueues();
+	TestNewInstance();
+#ifdef DEBUGDRAW_LOCK_STATS
+	TestLockStats();
+#endif
+
+	return ReportChecks("ProducerQueues");
+}
@@ -0,0 +1,81 @@
+// Measures how the add calls scale with the number of producer threads while render() runs on its own thread.
+// Not run by ctest, start it by hand: ProducerScalingBenchmark [seconds per thread count]
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <chrono>
+
+#include "DebugDrawManager.hpp"
+#include "TestDrawer.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+// Every thread keeps updating its own shapes, like separate script environments do
+static constexpr uint32 ShapesPerThread = 1000;
+static constexpr uint32 CallsPerCheck = 256;
+
+struct Result {
+	uint64 calls;
+	uint64 frames;
+	double seconds;
+	double renderSeconds;
+};
+
+static Result Run(uint32 threadCount, double seconds) {
+	TestDrawer drawer;
+	DebugDrawManager manager;
+	std::atomic<bool> bStop = false;
+	std::atomic<uint64> calls = 0;
+
+	std::vector<std::thread> vecProducers;
+	for ( uint32 t = 0; t < threadCount; ++t ) {
+		vecProducers.emplace_back([&, t] {
+			std::vector<std::string> vecNames;
+			for ( uint32 i = 0; i < ShapesPerThread; ++i )
+				vecNames.push_back("thread" + std::to_string(t) + "/shape" + std::to_string(i));
+			uint64 count = 0;
+			while ( !bStop.load(std::memory_order_relaxed) ) {
+				for ( uint32 i = 0; i < CallsPerCheck; ++i, ++count ) {
+					float offset = float(count % 64);
+					manager.addArrow(vecNames[count % ShapesPerThread], Vec3(offset, 0.0f, 0.0f), Vec3(offset, 1.0f, 0.0f), u8Vec3(255, 255, 255));
+				}
+			}
+			calls += count;
+		});
+	}
+
+	uint64 frames = 0;
+	double renderSeconds = 0.0;
+	Clock::time_point begin = Clock::now();
+	Clock::time_point end = begin + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+	while ( Clock::now() < end ) {
+		Clock::time_point frameBegin = Clock::now();
+		manager.render();
+		drawer.take();
+		renderSeconds += std::chrono::duration<double>(Clock::now() - frameBegin).count();
+		++frames;
+	}
+	bStop = true;
+	for ( std::thread& thread : vecProducers )
+		thread.join();
+	return {calls.load(), frames, std::chrono::duration<double>(Clock::now() - begin).count(), renderSeconds};
+}
+
+int main(int argc, char** argv) {
+	double seconds = (argc > 1 ? std::atof(argv[1]) : 1.0);
+	std::printf("%u hardware threads, %.2f s per run\n", std::thread::hardware_concurrency(), seconds);
+	std::printf("%8s %14s %16s %8s %12s\n", "threads", "calls/s", "calls/s/thread", "frames", "ms/frame");
+	for ( uint32 threadCount : {1u, 2u, 4u, 8u, 16u} ) {
+		Result result = Run(threadCount, seconds);
+		double callsPerSecond = double(result.calls) / result.seconds;
+		std::printf(
+			"%8u %14.0f %16.0f %8llu %12.3f\n", threadCount, callsPerSecond, callsPerSecond / threadCount,
+			(unsigned long long)result.frames, result.frames != 0 ? result.renderSeconds * 1000.0 / double(result.frames) : 0.0
+		);
+	}
+	return 0;
+}
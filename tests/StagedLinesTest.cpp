@@ -0,0 +1,93 @@
+// Tests of the lines staged by drawLine/drawLines, which render() keeps drawing until their frame count runs out.
+
+#include <thread>
+
+#include "DebugDrawManager.hpp"
+#include "TestDrawer.hpp"
+#include "Check.hpp"
+
+static const SM::LineVertex Line[2] = {
+	{Vec3(0.0f, 0.0f, 0.0f), u8Vec4(255, 255, 255, 255)},
+	{Vec3(1.0f, 0.0f, 0.0f), u8Vec4(255, 255, 255, 255)}
+};
+
+// Lines are drawn for exactly their frame count
+static void TestFrameCount(TestDrawer& drawer) {
+	DebugDrawManager manager;
+	manager.drawLines(Line, 2, 3);
+	for ( uint32 frame = 0; frame < 3; ++frame ) {
+		manager.render();
+		CHECK(drawer.take() == 2);
+	}
+	manager.render();
+	CHECK(drawer.take() == 0);
+}
+
+// A full clear drops the lines that are still drawn
+static void TestClearDropsDrawnLines(TestDrawer& drawer) {
+	DebugDrawManager manager;
+	manager.drawLines(Line, 2, 1000);
+	manager.render();
+	CHECK(drawer.take() == 2);
+	manager.clear();
+	manager.render();
+	CHECK(drawer.take() == 0);
+}
+
+// Lines staged before a clear in the same frame are dropped, the ones staged after it are drawn
+static void TestClearDropsStagedLines(TestDrawer& drawer) {
+	DebugDrawManager manager;
+	manager.drawLines(Line, 2, 1000);
+	manager.clear();
+	manager.drawLine(Line[0].point, Line[1].point, u8Vec3(255, 0, 0), 1000);
+	manager.drawLine(Line[0].point, Line[1].point, u8Vec3(255, 0, 0), 1000);
+	manager.render();
+	CHECK(drawer.take() == 4);
+	manager.render();
+	CHECK(drawer.take() == 4);
+}
+
+// Same with the clear pushed by another thread
+static void TestClearFromOtherThread(TestDrawer& drawer) {
+	DebugDrawManager manager;
+	manager.drawLines(Line, 2, 1000);
+	std::thread([&] {manager.clear();}).join();
+	manager.drawLines(Line, 2, 1000);
+	manager.drawLines(Line, 2, 1000);
+	manager.render();
+	CHECK(drawer.take() == 4);
+}
+
+// Clearing a prefix or a group keeps the lines
+static void TestPartialClearKeepsLines(TestDrawer& drawer) {
+	DebugDrawManager manager;
+	manager.drawLines(Line, 2, 1000);
+	manager.clear("a");
+	manager.clear("", DebugDrawManager::DefaultGroup + 1);
+	manager.render();
+	CHECK(drawer.take() == 2);
+}
+
+// Longer frame counts are cut to MaxLineFrames
+static void TestMaxLineFrames(TestDrawer& drawer) {
+	DebugDrawManager manager;
+	manager.drawLines(Line, 2, ~uint32(0));
+	uint32 drawnFrames = 0;
+	for ( uint32 frame = 0; frame < DebugDrawManager::MaxLineFrames + 1; ++frame ) {
+		manager.render();
+		drawnFrames += (drawer.take() != 0 ? 1 : 0);
+	}
+	CHECK(drawnFrames == DebugDrawManager::MaxLineFrames);
+}
+
+int main() {
+	TestDrawer drawer;
+	TestFrameCount(drawer);
+	TestClearDropsDrawnLines(drawer);
+	TestClearDropsStagedLines(drawer);
+	TestClearFromOtherThread(drawer);
+	TestPartialClearKeepsLines(drawer);
+	TestMaxLineFrames(drawer);
+
+	return ReportChecks("StagedLines");
+}
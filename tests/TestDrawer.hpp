@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstring>
+
+#include "SM/DebugDrawer.hpp"
+#include "SM/RenderStateManager.hpp"
+
+// Stands in for the game's drawer, so DebugDrawManager::render() can run in a test.
+// Only one may exist at a time, the game's RenderStateManager is pointed at it.
+class TestDrawer {
+	public:
+		TestDrawer() {
+			// The RenderStateManager only mirrors the game's memory, its drawer pointer sits behind _pad0
+			SM::DebugDrawer* pDrawer = &m_drawer;
+			std::memcpy(m_arrRenderStateManager + 0x260, &pDrawer, sizeof(pDrawer));
+			m_pRenderStateManager = reinterpret_cast<SM::RenderStateManager*>(m_arrRenderStateManager);
+			SM::RenderStateManager::_selfPtr = &m_pRenderStateManager;
+		}
+
+		TestDrawer(const TestDrawer&) = delete;
+		TestDrawer& operator=(const TestDrawer&) = delete;
+
+		inline SM::LineVertexArray& getLineVertices() {return m_drawer.getLineVertices();};
+
+		// Number of vertices drawn since the last call, the drawer is emptied like the game does every frame
+		uint32 take() {
+			uint32 count = m_drawer.getLineVertices().size();
+			m_drawer.getLineVertices().clear();
+			return count;
+		}
+
+	private:
+		SM::DebugDrawer m_drawer;
+		alignas(SM::RenderStateManager) char m_arrRenderStateManager[sizeof(SM::RenderStateManager)] = {};
+		SM::RenderStateManager* m_pRenderStateManager;
+};
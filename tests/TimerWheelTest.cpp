@@ -0,0 +1,138 @@
+// Deterministic tests of TimerWheel, time only moves through advance().
+
+#include <vector>
+#include <utility>
+
+#include "TimerWheel.hpp"
+#include "Check.hpp"
+
+// Every entry fires exactly at its tick, no matter which level it was scheduled into
+static void TestExactTicks() {
+	TimerWheel<uint64> wheel;
+	const uint64 deltas[] = {1, 2, 63, 64, 65, 4095, 4096, 4097, 262143, 262144, 300000, (uint64(1) << 24) + 5, (uint64(1) << 26) + 77};
+	for ( uint64 delta : deltas )
+		wheel.schedule(delta, delta);
+	CHECK(wheel.size() == std::size(deltas));
+
+	std::vector<std::pair<uint64, uint64>> vecFired;
+	uint64 tick = 0;
+	for ( uint64 delta : deltas ) {
+		// Advance in uneven steps up to every deadline
+		while ( tick < delta ) {
+			tick = (tick + 1000 < delta ? tick + 1000 : delta);
+			wheel.advance(tick, [&](uint64 expireTick, uint64 value) {vecFired.emplace_back(expireTick, value);});
+		}
+	}
+	CHECK(vecFired.size() == std::size(deltas));
+	for ( size_t i = 0; i < vecFired.size() && i < std::size(deltas); ++i ) {
+		CHECK(vecFired[i].first == deltas[i]);
+		CHECK(vecFired[i].second == deltas[i]);
+	}
+	CHECK(wheel.size() == 0);
+}
+
+// Nothing fires before its tick, even when advancing one tick at a time
+static void TestNotEarly() {
+	TimerWheel<uint64> wheel;
+	wheel.schedule(5000, 1);
+	bool bFired = false;
+	for ( uint64 tick = 1; tick < 5000; ++tick )
+		wheel.advance(tick, [&](uint64, uint64) {bFired = true;});
+	CHECK(!bFired);
+	wheel.advance(5000, [&](uint64 expireTick, uint64) {bFired = expireTick == 5000;});
+	CHECK(bFired);
+}
+
+// Entries due at or before the current tick fire on the next advance
+static void TestPastTicks() {
+	TimerWheel<uint64> wheel;
+	wheel.advance(100, [](uint64, uint64) {});
+	wheel.schedule(50, 1);
+	wheel.schedule(100, 2);
+	uint32 fired = 0;
+	wheel.advance(101, [&](uint64 expireTick, uint64) {
+		CHECK(expireTick == 101);
+		++fired;
+	});
+	CHECK(fired == 2);
+}
+
+// The pattern DebugDrawManager uses for shapes whose lifetime is refreshed: one entry per shape,
+// which is scheduled again from the callback while the shape's expiry is still ahead
+static void TestRescheduleFromCallback() {
+	constexpr uint64 Lifetime = 200;
+	constexpr uint64 LastRefresh = 1000;
+	TimerWheel<uint64> wheel;
+	uint64 expireTick = Lifetime;
+	uint64 timerTick = expireTick;
+	wheel.schedule(timerTick, 7);
+
+	uint64 expiredAt = 0;
+	uint32 maxSize = 0;
+	for ( uint64 tick = 1; tick <= LastRefresh + Lifetime + 10; ++tick ) {
+		wheel.advance(tick, [&](uint64 firedTick, uint64 value) {
+			CHECK(value == 7);
+			CHECK(firedTick == timerTick);
+			if ( expireTick <= firedTick ) {
+				expiredAt = firedTick;
+				return;
+			}
+			timerTick = expireTick;
+			wheel.schedule(timerTick, value);
+		});
+		if ( tick <= LastRefresh )
+			expireTick = tick + Lifetime;
+		maxSize = (wheel.size() > maxSize ? wheel.size() : maxSize);
+	}
+	CHECK(expiredAt == LastRefresh + Lifetime);
+	CHECK(maxSize == 1);
+	CHECK(wheel.size() == 0);
+}
+
+static void TestClear() {
+	TimerWheel<uint64> wheel;
+	for ( uint64 i = 1; i <= 10000; ++i )
+		wheel.schedule(i * 37, i);
+	wheel.clear();
+	CHECK(wheel.size() == 0);
+	uint32 fired = 0;
+	wheel.advance(400000, [&](uint64, uint64) {++fired;});
+	CHECK(fired == 0);
+}
+
+// Many entries spread over all levels expire in order of their ticks
+static void TestManyEntries() {
+	constexpr uint64 Count = 1000000;
+	TimerWheel<uint64> wheel;
+	uint64 seed = 1;
+	for ( uint64 i = 0; i < Count; ++i ) {
+		seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+		wheel.schedule(1 + (seed >> 40) % 100000, i);
+	}
+
+	uint64 fired = 0;
+	uint64 lastTick = 0;
+	bool bOrdered = true;
+	for ( uint64 tick = 0; tick <= 100000; tick += 16 ) {
+		wheel.advance(tick, [&](uint64 expireTick, uint64) {
+			bOrdered &= expireTick >= lastTick && expireTick <= tick;
+			lastTick = expireTick;
+			++fired;
+		});
+	}
+	wheel.advance(100001, [&](uint64, uint64) {++fired;});
+	CHECK(bOrdered);
+	CHECK(fired == Count);
+	CHECK(wheel.size() == 0);
+}
+
+int main() {
+	TestExactTicks();
+	TestNotEarly();
+	TestPastTicks();
+	TestRescheduleFromCallback();
+	TestClear();
+	TestManyEntries();
+
+	return ReportChecks("TimerWheel");
+}
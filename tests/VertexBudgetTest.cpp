@@ -0,0 +1,145 @@
+// Tests of the vertex budget, which drops or reduces shapes by priority once a frame would emit more vertices.
+
+#include <vector>
+#include <string>
+
+#include "DebugDrawManager.hpp"
+#include "IcoSphere.hpp"
+#include "TestDrawer.hpp"
+#include "Check.hpp"
+
+static const Vec3 Origin(0.0f, 0.0f, 0.0f);
+static const Vec3 Forward(1.0f, 0.0f, 0.0f);
+// Transforms draw their axes red, green and blue
+static const u8Vec3 Yellow(255, 255, 0);
+static const u8Vec3 Cyan(0, 255, 255);
+static const u8Vec3 Magenta(255, 0, 255);
+
+// Without a camera the detail level only depends on the radius
+static constexpr float LargeRadius = 2.0f;
+static constexpr float SmallRadius = 0.1f;
+static const uint32 SphereLevel0VertexCount = uint32(IcoSphere(0).getLines().size() * 2);
+static const uint32 SphereLevel2VertexCount = uint32(IcoSphere(2).getLines().size() * 2);
+
+// Number of drawn vertices of the given color
+static uint32 CountColor(TestDrawer& drawer, u8Vec3 color) {
+	u8Vec4 vertexColor = SM::ToLineVertexColor(color);
+	uint32 count = 0;
+	const SM::LineVertex* pVertices = drawer.getLineVertices().data();
+	for ( uint32 i = 0; i < drawer.getLineVertices().size(); ++i )
+		count += (pVertices[i].color == vertexColor ? 1 : 0);
+	return count;
+}
+
+// Whatever the budget, the frame never emits more, and every shape is drawn, reduced or counted as dropped
+static void TestBudgetIsKept(TestDrawer& drawer) {
+	constexpr uint32 ArrowCount = 50;
+	constexpr uint32 SphereCount = 10;
+	constexpr uint32 TransformCount = 10;
+	DebugDrawManager manager;
+	for ( uint32 i = 0; i < ArrowCount; ++i )
+		manager.addArrow("arrow" + std::to_string(i), Origin, Forward, Yellow);
+	for ( uint32 i = 0; i < SphereCount; ++i )
+		manager.addSphere("sphere" + std::to_string(i), Origin, LargeRadius, Cyan);
+	for ( uint32 i = 0; i < TransformCount; ++i )
+		manager.addTransform("transform" + std::to_string(i), Origin, Quat(1.0f, 0.0f, 0.0f, 0.0f), Vec3(1.0f));
+	uint32 fullVertexCount = ArrowCount * ArrowVertexCount + SphereCount * SphereLevel2VertexCount + TransformCount * TransformVertexCount;
+
+	for ( uint32 budget : {1u, 7u, 10u, 59u, 60u, 100u, 555u, 1000u, 5000u, fullVertexCount - 1} ) {
+		manager.setVertexBudget(budget);
+		manager.render();
+		DebugDrawManager::FrameStats stats = manager.getFrameStats();
+		uint32 arrows = CountColor(drawer, Yellow) / ArrowVertexCount;
+		uint32 spheres = CountColor(drawer, Cyan);
+		uint32 drawn = drawer.take();
+		CHECK(drawn <= budget);
+		CHECK(stats.emittedVertices == drawn);
+		uint32 transforms = (drawn - arrows * ArrowVertexCount - spheres) / TransformVertexCount;
+		uint32 fullSpheres = (spheres - stats.reducedSpheres * SphereLevel0VertexCount) / SphereLevel2VertexCount;
+		CHECK(arrows + fullSpheres + stats.reducedSpheres + transforms + stats.droppedShapes == ArrowCount + SphereCount + TransformCount);
+	}
+
+	// Once everything fits, nothing is dropped or reduced
+	manager.setVertexBudget(fullVertexCount);
+	manager.render();
+	DebugDrawManager::FrameStats stats = manager.getFrameStats();
+	CHECK(drawer.take() == fullVertexCount);
+	CHECK(stats.droppedShapes == 0 && stats.reducedSpheres == 0);
+}
+
+// Higher priority shapes are emitted first and keep their vertices, the lowest priority ones are dropped first
+static void TestPriorityOrder(TestDrawer& drawer) {
+	constexpr uint32 ArrowsPerPriority = 10;
+	DebugDrawManager manager;
+	manager.setPriority("high", DebugDrawPriority::High);
+	manager.setPriority("low", DebugDrawPriority::Low);
+	// Added lowest priority first, so the order can't come from the order they were added in
+	for ( uint32 i = 0; i < ArrowsPerPriority; ++i ) {
+		manager.addArrow("low" + std::to_string(i), Origin, Forward, Magenta);
+		manager.addArrow("normal" + std::to_string(i), Origin, Forward, Cyan);
+		manager.addArrow("high" + std::to_string(i), Origin, Forward, Yellow);
+	}
+	// All high ones and half of the normal ones
+	manager.setVertexBudget(ArrowsPerPriority * ArrowVertexCount * 3 / 2);
+	manager.render();
+	DebugDrawManager::FrameStats stats = manager.getFrameStats();
+
+	CHECK(CountColor(drawer, Yellow) == ArrowsPerPriority * ArrowVertexCount);
+	CHECK(CountColor(drawer, Cyan) == ArrowsPerPriority * ArrowVertexCount / 2);
+	CHECK(CountColor(drawer, Magenta) == 0);
+	CHECK(stats.droppedShapes == ArrowsPerPriority * 3 / 2);
+
+	// No vertex of a higher priority shape follows one of a lower priority
+	u8Vec4 yellow = SM::ToLineVertexColor(Yellow);
+	bool bSorted = true;
+	bool bSeenLower = false;
+	const SM::LineVertex* pVertices = drawer.getLineVertices().data();
+	for ( uint32 i = 0; i < drawer.getLineVertices().size(); ++i ) {
+		bool bHigh = pVertices[i].color == yellow;
+		bSorted &= !(bHigh && bSeenLower);
+		bSeenLower |= !bHigh;
+	}
+	CHECK(bSorted);
+	drawer.take();
+}
+
+// A sphere that doesn't fit falls back to the lowest level, and is only dropped if even that doesn't fit
+static void TestSphereFallback(TestDrawer& drawer) {
+	DebugDrawManager manager;
+	manager.addSphere("large", Origin, LargeRadius, Cyan);
+	manager.addArrow("arrow", Origin, Forward, Yellow);
+
+	manager.setVertexBudget(SphereLevel0VertexCount + ArrowVertexCount);
+	manager.render();
+	DebugDrawManager::FrameStats stats = manager.getFrameStats();
+	CHECK(CountColor(drawer, Cyan) == SphereLevel0VertexCount);
+	CHECK(CountColor(drawer, Yellow) == ArrowVertexCount);
+	CHECK(stats.reducedSpheres == 1 && stats.droppedShapes == 0);
+	CHECK(drawer.take() == SphereLevel0VertexCount + ArrowVertexCount);
+
+	// The arrow is emitted first, which leaves one vertex too few for the reduced sphere
+	manager.setVertexBudget(SphereLevel0VertexCount + ArrowVertexCount - 1);
+	manager.render();
+	stats = manager.getFrameStats();
+	CHECK(stats.reducedSpheres == 0 && stats.droppedShapes == 1);
+	CHECK(drawer.take() == ArrowVertexCount);
+
+	// A sphere already at the lowest level has nothing to fall back to
+	DebugDrawManager smallManager;
+	smallManager.addSphere("small", Origin, SmallRadius, Cyan);
+	smallManager.addArrow("arrow", Origin, Forward, Yellow);
+	smallManager.setVertexBudget(SphereLevel0VertexCount);
+	smallManager.render();
+	stats = smallManager.getFrameStats();
+	CHECK(stats.reducedSpheres == 0 && stats.droppedShapes == 1);
+	CHECK(drawer.take() == ArrowVertexCount);
+}
+
+int main() {
+	TestDrawer drawer;
+	TestBudgetIsKept(drawer);
+	TestPriorityOrder(drawer);
+	TestSphereFallback(drawer);
+
+	return ReportChecks("VertexBudget");
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+// Linux stand-in for the parts of Windows.h used by the sources the tests link
+
+#include <atomic>
+#include <thread>
+
+typedef char* LPSTR;
+typedef unsigned char BOOLEAN;
+
+// Holds the number of shared owners, or -1 while owned exclusively
+typedef struct {
+	std::atomic<long> state;
+} SRWLOCK;
+
+inline BOOLEAN TryAcquireSRWLockExclusive(SRWLOCK* pLock) {
+	long expected = 0;
+	return pLock->state.compare_exchange_strong(expected, -1, std::memory_order_acquire);
+}
+
+inline void AcquireSRWLockExclusive(SRWLOCK* pLock) {
+	while ( !TryAcquireSRWLockExclusive(pLock) )
+		std::this_thread::yield();
+}
+
+inline void ReleaseSRWLockExclusive(SRWLOCK* pLock) {
+	pLock->state.store(0, std::memory_order_release);
+}
+
+inline BOOLEAN TryAcquireSRWLockShared(SRWLOCK* pLock) {
+	long owners = pLock->state.load(std::memory_order_relaxed);
+	return owners >= 0 && pLock->state.compare_exchange_strong(owners, owners + 1, std::memory_order_acquire);
+}
+
+inline void AcquireSRWLockShared(SRWLOCK* pLock) {
+	while ( !TryAcquireSRWLockShared(pLock) )
+		std::this_thread::yield();
+}
+
+inline void ReleaseSRWLockShared(SRWLOCK* pLock) {
+	pLock->state.fetch_sub(1, std::memory_order_release);
+}
+
+// DebugDrawManager only draws when the game was started with -debugDraw
+inline LPSTR GetCommandLineA() {
+	static char s_commandLine[] = "ScrapMechanic.exe -debugDraw";
+	return s_commandLine;
+}
+
+#define min(a, b) (((a) < (b)) ? (a) : (b))
+#define max(a, b) (((a) > (b)) ? (a) : (b))